@@ -0,0 +1,15 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+O=$BUILDDIR/append-after-rescan.tags
+
+# The C++ parser rescans input.cpp. The tags of the failed pass must
+# not be left in a tag file opened for appending, where the position of
+# writes cannot be rewound.
+rm -f $O
+${CTAGS} --quiet --options=NONE --sort=no --extras=-p -o $O input.cpp
+${CTAGS} --quiet --options=NONE --sort=no --extras=-p -a -o $O input.cpp
+cat $O
+rm -f $O
@@ -0,0 +1,3 @@
+int alpha;
+static int beta (void) { return alpha; }
+struct gamma { int delta; };
@@ -0,0 +1,29 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+CACHE=$BUILDDIR/cache-dir-option-output-name.cache
+O="--quiet --options=NONE --verbose --cache-dir=$CACHE"
+
+# Print the number of input files whose tags are taken from the cache.
+count_hits()
+{
+	grep -c '^using cached tags'
+}
+
+rm -rf $CACHE
+echo "# cold"
+${CTAGS} $O -o $BUILDDIR/cache-dir-option-output-name-1.tags input.c input.py 2>&1 | count_hits
+echo "# another -o"
+${CTAGS} $O -o $BUILDDIR/cache-dir-option-output-name-2.tags input.c input.py 2>&1 | count_hits
+echo "# -f"
+${CTAGS} $O -f $BUILDDIR/cache-dir-option-output-name-3.tags input.c input.py 2>&1 | count_hits
+echo "# -L"
+printf 'input.c\ninput.py\n' | ${CTAGS} $O -o $BUILDDIR/cache-dir-option-output-name-4.tags -L - 2>&1 | count_hits
+for i in 2 3 4; do
+	cmp $BUILDDIR/cache-dir-option-output-name-1.tags $BUILDDIR/cache-dir-option-output-name-$i.tags \
+		&& echo "# $i: same as the cold run"
+done
+
+rm -rf $CACHE $BUILDDIR/cache-dir-option-output-name-*.tags
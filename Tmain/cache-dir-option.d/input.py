@@ -0,0 +1,3 @@
+class Epsilon:
+    def zeta(self):
+        pass
@@ -0,0 +1,25 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+CACHE=$BUILDDIR/cache-dir-option.cache
+
+rm -rf $CACHE
+for opts in "--sort=no --extras=+p --pseudo-tags=TAG_KIND_DESCRIPTION" "--fields=+n" "--output-format=etags"; do
+	echo "# $opts"
+	${CTAGS} --quiet --options=NONE $opts -o - input.c input.py > $BUILDDIR/cache-dir-option-uncached.tmp
+	for run in cold warm; do
+		${CTAGS} --quiet --options=NONE --cache-dir=$CACHE $opts -o - input.c input.py > $BUILDDIR/cache-dir-option.tmp
+		cmp $BUILDDIR/cache-dir-option.tmp $BUILDDIR/cache-dir-option-uncached.tmp && echo "# $run: same as uncached"
+	done
+	cat $BUILDDIR/cache-dir-option.tmp
+	rm -f $BUILDDIR/cache-dir-option.tmp $BUILDDIR/cache-dir-option-uncached.tmp
+done
+echo "# cache files: $(ls $CACHE | wc -l)"
+
+echo "# broken cache file"
+for f in $CACHE/*; do echo garbage > $f; done
+${CTAGS} --quiet --options=NONE --cache-dir=$CACHE --fields=+n -o - input.c input.py
+
+rm -rf $CACHE
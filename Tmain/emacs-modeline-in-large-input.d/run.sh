@@ -0,0 +1,34 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+D=$BUILDDIR/emacs-modeline-in-large-input.tmp
+
+# The files are larger than the windows of the input which the eager
+# tasters look at.
+rm -rf $D
+mkdir -p $D
+i=0
+while [ $i -lt 2000 ]; do
+	echo "x = $i"
+	i=$((i + 1))
+done > $D/body
+
+{ cat $D/body; printf '# Local Variables:\n# mode: python\n# End:\n'; } > $D/local-variables-at-eof
+{ printf '# Local Variables:\n# mode: python\n# End:\n'; cat $D/body; } > $D/local-variables-at-head
+{ cat $D/body; printf '# vim: ft=ruby\n'; } > $D/vim-modeline-at-eof
+{ cat $D/body; printf '# vim: ft=ruby\n\n\n\n\n'; } > $D/vim-modeline-in-last-5-lines
+{ cat $D/body; printf '# vim: ft=ruby\n\n\n\n\n\n'; } > $D/vim-modeline-out-of-last-5-lines
+{ printf '#!/usr/bin/env ruby\n'; cat $D/body; } > $D/interpreter
+rm $D/body
+
+$CTAGS --quiet --options=NONE -G --print-language \
+	   $D/interpreter \
+	   $D/local-variables-at-eof \
+	   $D/local-variables-at-head \
+	   $D/vim-modeline-at-eof \
+	   $D/vim-modeline-in-last-5-lines \
+	   $D/vim-modeline-out-of-last-5-lines | sed -e "s|^$D/||"
+
+rm -rf $D
@@ -0,0 +1,43 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+D=$BUILDDIR/incremental-option-escaped-names
+
+TAB=$(printf '\t')
+NL=$(printf '\nx')
+NL=${NL%x}
+
+run_ctags()
+{
+	( cd $D && ${CTAGS} --quiet --options=NONE \
+			--verbose --incremental "$@" -R src 2>&1 > /dev/null ) > $D/log
+	grep -e '^no stamps' -e '^options differ' -e 'broken line' $D/log
+	echo "unchanged: $(grep -c '(unchanged)$' $D/log)"
+	echo '# tags'
+	grep -v '^!_TAG_PROGRAM' $D/tags
+}
+
+rm -rf $D
+mkdir -p $D/src
+echo 'int a (void) { return 0; }' > "$D/src/a${TAB}tab.c"
+echo 'int b (void) { return 0; }' > "$D/src/b${NL}newline.c"
+echo 'int c (void) { return 0; }' > "$D/src/c\\backslash.c"
+touch -t 202001010000 "$D/src/a${TAB}tab.c" "$D/src/b${NL}newline.c" "$D/src/c\\backslash.c"
+
+echo '# the first run'
+run_ctags
+
+echo '# nothing changed'
+run_ctags
+
+echo '# the file having a tab in its name modified'
+echo 'int a2 (void) { return 0; }' > "$D/src/a${TAB}tab.c"
+run_ctags
+
+echo '# the same as a full run'
+( cd $D && ${CTAGS} --quiet --options=NONE -R -o tags.full src )
+cmp $D/tags $D/tags.full && echo same
+
+rm -rf $D
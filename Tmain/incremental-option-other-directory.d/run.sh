@@ -0,0 +1,31 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+D=$BUILDDIR/incremental-option-other-directory
+
+rm -rf $D
+mkdir -p $D/src
+echo 'int a (void) { return 0; }' > $D/src/a.c
+echo 'int b (void) { return 0; }' > $D/src/b.c
+
+echo '# the first run at the top directory'
+( cd $D && ${CTAGS} --quiet --options=NONE --incremental --tag-relative=yes -o tags src/a.c src/b.c )
+grep -v '^!_' $D/tags
+
+# src/b.c is recorded relative to the tag file. It must not be
+# taken as removed when ctags runs in src.
+echo '# a.c modified, and ctags run in src'
+echo 'int a2 (void) { return 0; }' > $D/src/a.c
+( cd $D/src && ${CTAGS} --quiet --options=NONE --verbose --incremental --tag-relative=yes -o ../tags a.c 2>&1 > /dev/null \
+	  | grep -e '^dropping' )
+grep -v '^!_' $D/tags
+
+echo '# b.c removed, and ctags run in src'
+rm $D/src/b.c
+( cd $D/src && ${CTAGS} --quiet --options=NONE --verbose --incremental --tag-relative=yes -o ../tags a.c 2>&1 > /dev/null \
+	  | grep -e '^skipping' -e '^dropping' )
+grep -v '^!_' $D/tags
+
+rm -rf $D
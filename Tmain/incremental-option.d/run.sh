@@ -0,0 +1,64 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+D=$BUILDDIR/incremental-option
+
+run_ctags()
+{
+	( cd $D && ${CTAGS} --quiet --options=NONE \
+			--verbose --incremental "$@" -R src 2>&1 > /dev/null \
+		  | grep -e '^skipping' -e '^dropping' -e '^no stamps' -e '^options differ' )
+	echo '# tags'
+	grep -v '^!_TAG_PROGRAM' $D/tags
+}
+
+rm -rf $D
+mkdir -p $D/src
+echo 'int a (void) { return 0; }' > $D/src/a.c
+echo 'int b (void) { return 0; }' > $D/src/b.c
+printf 'def c ():\n    pass\n' > $D/src/c.py
+touch -t 202001010000 $D/src/a.c $D/src/b.c $D/src/c.py
+
+echo '# the first run'
+run_ctags
+
+echo '# b.c modified, c.py removed, d.c added, and a.c touched'
+echo 'int b2 (void) { return 0; }' > $D/src/b.c
+rm $D/src/c.py
+echo 'int d (void) { return 0; }' > $D/src/d.c
+touch $D/src/a.c
+run_ctags --jobs=2
+
+echo '# the same as a full run'
+( cd $D && ${CTAGS} --quiet --options=NONE -R -o tags.full src )
+cmp $D/tags $D/tags.full && echo same
+
+echo '# stamps file lost'
+rm $D/tags.stamps
+run_ctags
+
+echo '# options changed'
+run_ctags --fields=+n
+
+echo '# options unchanged'
+run_ctags --fields=+n
+
+echo '# unsorted, with parser specific pseudo tags'
+rm -f $D/tags $D/tags.stamps $D/tags.full
+O="--quiet --options=NONE --sort=no --pseudo-tags=+TAG_KIND_DESCRIPTION"
+( cd $D && ${CTAGS} $O --incremental -R src )
+echo 'int b3 (void) { return 0; }' > $D/src/b.c
+( cd $D && ${CTAGS} $O --incremental -R src )
+( cd $D && ${CTAGS} $O -R -o tags.full src )
+grep -c '^!_TAG_KIND_DESCRIPTION!C	' $D/tags
+sort $D/tags > $D/tags.sorted
+sort $D/tags.full > $D/tags.full.sorted
+cmp $D/tags.sorted $D/tags.full.sorted && echo same
+
+rm -rf $D
+
+echo '# stdout'
+${CTAGS} --quiet --options=NONE --incremental -o - src
+exit $?
@@ -0,0 +1,34 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+D=$BUILDDIR/jobs-option-recursive.tmp
+
+# More files than a batch of two workers takes, so that some of them are
+# parsed while ctags is still looking for the rest.
+rm -rf $D
+mkdir -p $D
+for d in 0 1 2 3; do
+	mkdir $D/dir$d
+	i=0
+	while [ $i -lt 200 ]; do
+		echo "int f${d}_$i (void) { return $i; }" > $D/dir$d/input$i.c
+		i=$((i + 1))
+	done
+	echo "def g$d(): pass" > $D/dir$d/input.py
+	: > $D/dir$d/excluded.c
+done
+ln -s dir0 $D/link-to-dir0
+ln -s ../dir1/input0.c $D/dir2/link-to-input0.c
+
+for opts in "" "--links=no"; do
+	echo "# $opts"
+	(cd $D; ${CTAGS} --quiet --options=NONE --sort=no -R --exclude=excluded.c $opts --jobs=2 -o - . > ../jobs-option-recursive.tags)
+	(cd $D; ${CTAGS} --quiet --options=NONE --sort=no -R --exclude=excluded.c $opts --jobs=1 -o - . > ../jobs-option-recursive-sequential.tags)
+	wc -l < $BUILDDIR/jobs-option-recursive.tags
+	cmp $BUILDDIR/jobs-option-recursive.tags $BUILDDIR/jobs-option-recursive-sequential.tags && echo "# same as --jobs=1"
+	rm -f $BUILDDIR/jobs-option-recursive.tags $BUILDDIR/jobs-option-recursive-sequential.tags
+done
+
+rm -rf $D
@@ -0,0 +1,24 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+FILES="src/a.c src/b.py src/c.f src/d.f src/e.c src/c.f"
+
+for opts in "--sort=no" "--sort=no --extras=+p --pseudo-tags=TAG_KIND_DESCRIPTION" "--output-format=etags"; do
+	echo "# $opts"
+	${CTAGS} --quiet --options=NONE --jobs=3 $opts -o - $FILES > $BUILDDIR/jobs-option.tmp
+	${CTAGS} --quiet --options=NONE --jobs=1 $opts -o - $FILES > $BUILDDIR/jobs-option-sequential.tmp
+	cat $BUILDDIR/jobs-option.tmp
+	cmp $BUILDDIR/jobs-option.tmp $BUILDDIR/jobs-option-sequential.tmp && echo "# same as --jobs=1"
+	rm -f $BUILDDIR/jobs-option.tmp $BUILDDIR/jobs-option-sequential.tmp
+done
+
+echo "# options between input files"
+${CTAGS} --quiet --options=NONE --jobs=2 --sort=no -o - src/a.c src/b.py --fields=+n src/e.c src/c.f
+
+echo "# invalid parameter"
+${CTAGS} --quiet --options=NONE --jobs=257 -o - src/a.c
+echo $?
+${CTAGS} --quiet --options=NONE --jobs=0 -o - src/a.c
+exit $?
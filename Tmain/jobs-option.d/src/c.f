@@ -0,0 +1,3 @@
+      PROGRAM FIXED
+      INTEGER I
+      END
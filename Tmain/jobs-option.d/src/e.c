@@ -0,0 +1 @@
+struct e { int m; };
@@ -0,0 +1 @@
+int builda = 1;
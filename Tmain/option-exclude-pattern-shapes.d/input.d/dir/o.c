@@ -0,0 +1 @@
+int o = 1;
@@ -0,0 +1 @@
+int gen = 1;
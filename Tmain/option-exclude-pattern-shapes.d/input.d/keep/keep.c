@@ -0,0 +1 @@
+int keep = 1;
@@ -0,0 +1 @@
+int w = 1;
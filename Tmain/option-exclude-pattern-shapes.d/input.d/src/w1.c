@@ -0,0 +1 @@
+int w1 = 1;
@@ -0,0 +1 @@
+int z = 1;
@@ -0,0 +1,22 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS="$1"
+
+# a name, a suffix, a prefix, a path, and a glob having two wildcards
+${CTAGS} --quiet --options=NONE -o - -R \
+		 --exclude=gen \
+		 --exclude='*.h' \
+		 --exclude='build*' \
+		 --exclude=input.d/dir \
+		 --exclude='*/src/w?.c' \
+		 --exclude=Makefile \
+		 input.d
+
+echo '# with exceptions'
+${CTAGS} --quiet --options=NONE -o - -R \
+		 --exclude='*.c' \
+		 --exclude='*.h' \
+		 --exclude-exception='*/build-a/*' \
+		 --exclude-exception=keep.c \
+		 input.d
@@ -0,0 +1,4 @@
+class Test
+  def foobar
+  end
+end
@@ -0,0 +1,33 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+
+O="--quiet --options=NONE"
+
+echo "# file and buffer requests"
+{
+	echo 'file input.rb'
+	echo 'buffer 17 unsaved.rb'
+	echo 'def foobaz() end'
+	echo 'file no-such-file.rb'
+	echo 'unknown'
+	echo 'file input.rb'
+	echo 'quit'
+	echo 'file input.rb'
+} | ${CTAGS} $O --_server --fields=+K
+
+echo "# unsorted"
+printf 'buffer 24 unsaved.py\ndef foo():\n    return 1\nbuffer 24 unsaved2.py\ndef bar():\n    return 1\n' \
+	| ${CTAGS} $O --_server --sort=no
+
+echo "# short buffer"
+printf 'buffer 100 unsaved.py\ndef foo():\n' | ${CTAGS} $O --_server
+
+echo "# too large buffers"
+printf 'buffer 18446744073709551615 unsaved.py\ndef foo():\n' | ${CTAGS} $O --_server
+printf 'buffer 99999999999999999999999 unsaved.py\ndef foo():\n' | ${CTAGS} $O --_server
+printf 'buffer 268435457 unsaved.py\ndef foo():\n' | ${CTAGS} $O --_server
+
+echo "# input files on the command line"
+${CTAGS} $O --_server input.rb < /dev/null
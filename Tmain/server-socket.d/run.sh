@@ -0,0 +1,50 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+. ../utils.sh
+
+CTAGS=$1
+BUILDDIR=$2
+O="--quiet --options=NONE"
+S=$BUILDDIR/server-socket.sock
+LOG=$BUILDDIR/server-socket.log
+
+# Run a server, and wait until it listens on the socket.
+start_server()
+{
+	local i=0
+
+	${CTAGS} $O --verbose --_server=$S 2> $LOG &
+	pid=$!
+	while ! grep -q "serving on socket" $LOG; do
+		if [ $i -ge 100 ] || ! kill -0 $pid 2>/dev/null; then
+			kill $pid 2>/dev/null
+			rm -f $S $LOG
+			skip "--_server=SOCKET is not available"
+		fi
+		sleep 0.1
+		i=$((i + 1))
+	done
+}
+
+rm -f $S
+
+# The socket must not be open to the others whatever the umask is.
+umask 022
+start_server
+echo "# permissions of the socket"
+ls -l $S | cut -c 1-10
+
+echo "# server already running"
+${CTAGS} $O --_server=$S 2>&1 | sed -e "s|$S|SOCKET|"
+
+echo "# socket left by a server gone"
+kill -KILL $pid
+wait $pid 2>/dev/null
+start_server
+${CTAGS} $O --_server=$S 2>&1 | sed -e "s|$S|SOCKET|"
+
+kill $pid
+wait $pid 2>/dev/null
+rm -f $S $LOG
+exit 0
@@ -0,0 +1,21 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+# input.c is given twice to make identical tag lines.
+for opts in "--sort=yes" "--sort=foldcase" "-x"; do
+	echo "# $opts"
+	${CTAGS} --quiet --options=NONE --sort-in-memory $opts -o - input.c input.c > $BUILDDIR/sort-in-memory-option.tmp
+	${CTAGS} --quiet --options=NONE $opts -o - input.c input.c > $BUILDDIR/sort-in-memory-option-file.tmp
+	cat $BUILDDIR/sort-in-memory-option.tmp
+	cmp $BUILDDIR/sort-in-memory-option.tmp $BUILDDIR/sort-in-memory-option-file.tmp && echo "# same as the default"
+	rm -f $BUILDDIR/sort-in-memory-option.tmp $BUILDDIR/sort-in-memory-option-file.tmp
+done
+
+echo "# tag file"
+${CTAGS} --quiet --options=NONE --sort-in-memory --extras=+p -f $BUILDDIR/sort-in-memory-option.tags input.c
+${CTAGS} --quiet --options=NONE --extras=+p -f $BUILDDIR/sort-in-memory-option-file.tags input.c
+cmp $BUILDDIR/sort-in-memory-option.tags $BUILDDIR/sort-in-memory-option-file.tags && echo "# same as the default"
+rm -f $BUILDDIR/sort-in-memory-option.tags $BUILDDIR/sort-in-memory-option-file.tags
@@ -0,0 +1,12 @@
+int zeta;
+int Alpha;
+int alpha;
+int ALPHA;
+int beta (void) { return 0; }
+struct Gamma { int delta; int Delta; };
+enum epsilon { Eta, eta, Theta, iota };
+#define KAPPA 1
+#define kappa 2
+static int lambda;
+int Mu, mu, Nu, nu, xi, Xi;
+typedef int omicron;
@@ -0,0 +1,20 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+
+# input.c is given twice to make identical tag lines; they must be
+# dropped as "sort -u" does, also with -x.
+for opts in "--sort=yes" "--sort=foldcase" "-x"; do
+	echo "# $opts"
+	${CTAGS} --quiet --options=NONE --sort-memory=1 $opts -o - input.c input.c > $BUILDDIR/sort-memory-option.tmp
+	${CTAGS} --quiet --options=NONE $opts -o - input.c input.c > $BUILDDIR/sort-memory-option-default.tmp
+	cat $BUILDDIR/sort-memory-option.tmp
+	cmp $BUILDDIR/sort-memory-option.tmp $BUILDDIR/sort-memory-option-default.tmp && echo "# same as the default"
+	rm -f $BUILDDIR/sort-memory-option.tmp $BUILDDIR/sort-memory-option-default.tmp
+done
+
+echo "# invalid parameter"
+${CTAGS} --quiet --options=NONE --sort-memory=1x -o - input.c
+exit $?
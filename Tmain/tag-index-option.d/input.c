@@ -0,0 +1,7 @@
+int Main;
+int main;
+int mainLoop;
+int MAIN_LOOP;
+int maintain;
+int other;
+static int main_loop (void) { return 0; }
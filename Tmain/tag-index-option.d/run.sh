@@ -0,0 +1,60 @@
+# Copyright: 2026 Universal Ctags Team
+# License: GPL-2
+
+CTAGS=$1
+BUILDDIR=$2
+READTAGS=$3
+TAGS=$BUILDDIR/tag-index-option.tags
+
+. ../utils.sh
+
+if ! [ -x "${READTAGS}" ]; then
+	skip "no readtags"
+fi
+
+# The index finds tags in the order of their names; compare the tags
+# found with and without it after sorting them.
+lookup()
+{
+	echo "## $*"
+	${READTAGS} -t $TAGS "$@" > $BUILDDIR/tag-index-option.tmp
+	cat $BUILDDIR/tag-index-option.tmp
+	mv $TAGS.idx $TAGS.idx.saved
+	${READTAGS} -t $TAGS "$@" | sort > $BUILDDIR/tag-index-option-noidx.tmp
+	mv $TAGS.idx.saved $TAGS.idx
+	sort $BUILDDIR/tag-index-option.tmp | cmp - $BUILDDIR/tag-index-option-noidx.tmp || echo "# differs from the one without the index"
+	rm -f $BUILDDIR/tag-index-option.tmp $BUILDDIR/tag-index-option-noidx.tmp
+}
+
+for opts in "--sort=yes" "--sort=foldcase" "--sort=no"; do
+	echo "# $opts"
+	rm -f $TAGS $TAGS.idx
+	${CTAGS} --quiet --options=NONE --tag-index $opts -f $TAGS input.c
+	[ -f $TAGS.idx ] && echo "# index made"
+	lookup main
+	lookup -i main
+	lookup -p main
+	lookup -i -p main
+	lookup -i -p MAIN_
+	lookup nosuchtag
+	lookup -p nosuchtag
+done
+
+echo "# the tag file modified after making the index"
+echo "main	input.c	/^int main;$/;\"	v" >> $TAGS
+${READTAGS} -t $TAGS main
+
+echo "# the tag file modified in the same size, and its mtime set back"
+${CTAGS} --quiet --options=NONE --tag-index --sort=no -f $TAGS input.c
+sed -e 's/^main	/niam	/' $TAGS > $TAGS.tmp
+touch -t 200001010000 $TAGS.tmp
+mv $TAGS.tmp $TAGS
+${READTAGS} -t $TAGS main
+${READTAGS} -t $TAGS niam
+
+rm -f $TAGS $TAGS.idx
+
+echo "# incompatible options"
+${CTAGS} --quiet --options=NONE --tag-index -o - input.c
+${CTAGS} --quiet --options=NONE --tag-index -e -f $TAGS input.c
+rm -f $TAGS
@@ -0,0 +1,6 @@
+      PROGRAM FIXED
+      INTEGER I
+      END
+      SUBROUTINE LONG
+     &NAME
+      END
@@ -0,0 +1,6 @@
+module free
+  integer :: j
+contains
+  subroutine s ()
+  end subroutine s
+end module free
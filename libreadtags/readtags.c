@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <sys/types.h>  /* to declare off_t */
+#include <sys/stat.h>
 
 #include "readtags.h"
 
@@ -23,6 +24,11 @@
 */
 #define TAB '\t'
 
+#define INDEX_SUFFIX ".idx"
+#define INDEX_MAGIC "!_TAGIDX"
+#define INDEX_VERSION 2
+#define INDEX_HEADER_SIZE 80
+
 
 /*
 *   DATA DECLARATIONS
@@ -63,6 +69,26 @@ struct sTagFile {
 				/* ignoring case */
 			short ignorecase;
 	} search;
+		/* index of the tag file made by ctags --tag-index */
+	struct {
+				/* pointer to file structure; NULL if no index */
+			FILE *fp;
+				/* size of the tag file when the index was made */
+			off_t tagFileSize;
+				/* number of tags in the arrays */
+			unsigned long count;
+				/* number of entries in each hash table */
+			unsigned long bucketCount;
+				/* file positions of the arrays and the hash tables */
+			long sortedPos;
+			long foldedPos;
+			long bucketsPos;
+			long foldedBucketsPos;
+				/* the last search used the index */
+			short active;
+				/* array element to be examined by the next search */
+			unsigned long next;
+	} index;
 		/* miscellaneous extension fields */
 	struct {
 				/* number of entries in `list' */
@@ -647,6 +673,59 @@ static void gotoFirstLogicalTag (tagFile *const file)
 	fsetpos (file->fp, &startOfLine);
 }
 
+static unsigned long long getIndexNumber (const unsigned char *buf, int size)
+{
+	unsigned long long n = 0;
+	int i;
+	for (i = size - 1  ;  i >= 0  ;  --i)
+		n = (n << 8) | buf [i];
+	return n;
+}
+
+static int readIndexNumbers (tagFile *const file, long pos,
+							 unsigned char *buf, size_t size)
+{
+	return (fseek (file->index.fp, pos, SEEK_SET) == 0  &&
+			fread (buf, 1, size, file->index.fp) == size);
+}
+
+/* Opens the index made by ctags --tag-index if it is for the tag file */
+static void openIndex (tagFile *const file, const char *const filePath)
+{
+	unsigned char header [INDEX_HEADER_SIZE];
+	struct stat tagStat;
+	char *indexPath = (char*) malloc (strlen (filePath) + sizeof (INDEX_SUFFIX));
+	if (indexPath == NULL)
+		return;
+	strcpy (indexPath, filePath);
+	strcat (indexPath, INDEX_SUFFIX);
+
+	if (stat (filePath, &tagStat) == 0)
+		file->index.fp = fopen (indexPath, "rb");
+	free (indexPath);
+	if (file->index.fp == NULL)
+		return;
+
+	if (! readIndexNumbers (file, 0, header, sizeof (header))  ||
+		memcmp (header, INDEX_MAGIC, 8) != 0  ||
+		getIndexNumber (header + 8, 4) != INDEX_VERSION  ||
+		(off_t) getIndexNumber (header + 16, 8) != file->size  ||
+		/* The tag file modified after making the index may have the same size. */
+		getIndexNumber (header + 24, 8) != (unsigned long long) tagStat.st_mtime)
+	{
+		fclose (file->index.fp);
+		file->index.fp = NULL;
+		return;
+	}
+	file->index.tagFileSize = (off_t) getIndexNumber (header + 16, 8);
+	file->index.count = (unsigned long) getIndexNumber (header + 32, 8);
+	file->index.bucketCount = (unsigned long) getIndexNumber (header + 40, 8);
+	file->index.sortedPos = (long) getIndexNumber (header + 48, 8);
+	file->index.foldedPos = (long) getIndexNumber (header + 56, 8);
+	file->index.bucketsPos = (long) getIndexNumber (header + 64, 8);
+	file->index.foldedBucketsPos = (long) getIndexNumber (header + 72, 8);
+}
+
 static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 {
 	tagFile *result = (tagFile*) calloc ((size_t) 1, sizeof (tagFile));
@@ -684,6 +763,7 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 				goto file_error;
 			}
 			rewind (result->fp);
+			openIndex (result, filePath);
 			readPseudoTags (result, info);
 			if (info)
 				info->status.opened = 1;
@@ -707,6 +787,8 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 static void terminate (tagFile *const file)
 {
 	fclose (file->fp);
+	if (file->index.fp != NULL)
+		fclose (file->index.fp);
 
 	free (file->line.buffer);
 	free (file->name.buffer);
@@ -895,6 +977,115 @@ static tagResult findSequential (tagFile *const file)
 	return findSequentialFull (file, nameAcceptable, NULL);
 }
 
+/* Reads the tag line pointed by the element I of the array in the index */
+static int readIndexedTagLine (tagFile *const file, unsigned long i)
+{
+	unsigned char buf [8];
+	const long arrayPos = file->search.ignorecase?
+		file->index.foldedPos: file->index.sortedPos;
+	if (! readIndexNumbers (file, arrayPos + 8L * (long) i, buf, sizeof (buf)))
+		return 0;
+	if (fseek (file->fp, (long) getIndexNumber (buf, 8), SEEK_SET) != 0)
+		return 0;
+	return readTagLineRaw (file);
+}
+
+/* Compares the name searched for with the leading characters of the name
+ * in the last line read, in the order of the arrays in the index */
+static int indexedNameComparison (tagFile *const file)
+{
+	const unsigned char *s1 = (const unsigned char *) file->search.name;
+	const char *s2 = file->name.buffer;
+	size_t n = file->search.nameLength;
+	int c1, c2;
+	while (n-- > 0)
+	{
+		c1 = *s1++;
+		c2 = (unsigned char) readTagCharacter (&s2);
+		if (file->search.ignorecase)
+		{
+			c1 = toupper (c1);
+			c2 = toupper (c2);
+		}
+		if (c1 != c2)
+			return c1 - c2;
+	}
+	return 0;
+}
+
+static tagResult findIndexedPartial (tagFile *const file)
+{
+	unsigned long lower_limit = 0;
+	unsigned long upper_limit = file->index.count;
+	while (lower_limit < upper_limit)
+	{
+		const unsigned long i = lower_limit + (upper_limit - lower_limit) / 2;
+		if (! readIndexedTagLine (file, i))
+			return TagFailure;
+		if (indexedNameComparison (file) > 0)
+			lower_limit = i + 1;
+		else
+			upper_limit = i;
+	}
+	if (lower_limit < file->index.count  &&
+		readIndexedTagLine (file, lower_limit)  &&
+		nameComparison (file) == 0)
+	{
+		file->index.next = lower_limit + 1;
+		return TagSuccess;
+	}
+	return TagFailure;
+}
+
+static tagResult findIndexedFull (tagFile *const file)
+{
+	const long bucketsPos = file->search.ignorecase?
+		file->index.foldedBucketsPos: file->index.bucketsPos;
+	const unsigned long mask = file->index.bucketCount - 1;
+	const unsigned char *s = (const unsigned char *) file->search.name;
+	unsigned long hash = 2166136261UL;
+	unsigned long b, probes;
+	unsigned char buf [8];
+
+	/* 32 bit FNV-1a */
+	for (  ;  *s != '\0'  ;  ++s)
+	{
+		hash ^= (unsigned long) (file->search.ignorecase? toupper (*s): *s);
+		hash = (hash * 16777619UL) & 0xffffffffUL;
+	}
+
+	for (b = hash & mask, probes = 0  ;  probes <= mask  ;  b = (b + 1) & mask, ++probes)
+	{
+		unsigned long i;
+		if (! readIndexNumbers (file, bucketsPos + 8L * (long) b, buf, sizeof (buf)))
+			break;
+		i = (unsigned long) getIndexNumber (buf + 4, 4);
+		if (i == 0)
+			break;
+		if ((unsigned long) getIndexNumber (buf, 4) == hash  &&
+			i <= file->index.count  &&
+			readIndexedTagLine (file, i - 1)  &&
+			nameComparison (file) == 0)
+		{
+			file->index.next = i;
+			return TagSuccess;
+		}
+	}
+	return TagFailure;
+}
+
+static tagResult findIndexedNext (tagFile *const file, tagEntry *const entry)
+{
+	if (file->index.next >= file->index.count  ||
+		! readIndexedTagLine (file, file->index.next)  ||
+		nameComparison (file) != 0)
+		return TagFailure;
+	file->index.next++;
+	if (entry != NULL)
+		parseTagLine (file, entry);
+	return TagSuccess;
+}
+
 static tagResult find (tagFile *const file, tagEntry *const entry,
 					   const char *const name, const int options)
 {
@@ -908,7 +1099,21 @@ static tagResult find (tagFile *const file, tagEntry *const entry,
 	fseek (file->fp, 0, SEEK_END);
 	file->size = ftell (file->fp);
 	rewind (file->fp);
-	if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
+	file->index.active = (file->index.fp != NULL  &&
+						  file->index.count > 0  &&
+						  file->index.tagFileSize == file->size  &&
+						  strncmp (name, PseudoTagPrefix, PseudoTagPrefixLength) != 0);
+	if (file->index.active)
+	{
+#ifdef DEBUG
+		printf ("<performing indexed search>\n");
+#endif
+		if (file->search.partial)
+			result = findIndexedPartial (file);
+		else
+			result = findIndexedFull (file);
+	}
+	else if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
 		(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
 	{
 #ifdef DEBUG
@@ -958,6 +1163,8 @@ static tagResult findNextFull (tagFile *const file, tagEntry *const entry,
 
 static tagResult findNext (tagFile *const file, tagEntry *const entry)
 {
+	if (file->index.active)
+		return findIndexedNext (file, entry);
 	return findNextFull (file, entry,
 						 (file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
 						 (file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase),
@@ -223,6 +223,11 @@ extern const char *tagsField (const tagEntry *const entry, const char *const key
 *        Matching will be performed in a case-sensitive manner. Note that
 *        this enables binary searches of the tag file.
 *
+*  If an index of the tag file (made with the --tag-index option of ctags) is
+*  found next to it, the index is used instead of searching the tag file,
+*  whether the tag file is sorted or not, and whatever the options are. The
+*  matching tags are then found in the order of their names.
+*
 *  The function will return TagSuccess if a tag matching the name is found, or
 *  TagFailure if not.
 */
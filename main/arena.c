@@ -0,0 +1,139 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains a bump-pointer allocator. Objects allocated from an
+*   arena are not freed one by one; they are all released at once when the
+*   arena is reset or deleted.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+
+#include "arena_p.h"
+#include "debug.h"
+#include "routines.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef union uArenaAlign {
+	long double d;
+	long long l;
+	void *p;
+	void (*f) (void);
+} arenaAlign;
+
+typedef struct sArenaChunk {
+	struct sArenaChunk *next;
+	size_t size;
+	size_t used;
+	arenaAlign data [];
+} arenaChunk;
+
+struct sArena {
+	arenaChunk *chunks;			/* the chunk being filled comes first */
+	size_t chunkSize;
+};
+
+/*
+*   MACROS
+*/
+#define ARENA_ALIGN(N) (((N) + sizeof (arenaAlign) - 1) & ~(sizeof (arenaAlign) - 1))
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static arenaChunk *newChunk (size_t size)
+{
+	arenaChunk *chunk = eMalloc (sizeof (arenaChunk) + size);
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+	return chunk;
+}
+
+extern Arena *arenaNew (size_t chunkSize)
+{
+	Arena *arena = xMalloc (1, Arena);
+
+	arena->chunkSize = ARENA_ALIGN (chunkSize);
+	arena->chunks = newChunk (arena->chunkSize);
+	return arena;
+}
+
+extern void arenaDelete (Arena *arena)
+{
+	arenaChunk *chunk = arena->chunks;
+
+	while (chunk)
+	{
+		arenaChunk *next = chunk->next;
+		eFree (chunk);
+		chunk = next;
+	}
+	eFree (arena);
+}
+
+extern void *arenaAlloc (Arena *arena, size_t size)
+{
+	arenaChunk *chunk = arena->chunks;
+	void *p;
+
+	size = ARENA_ALIGN (size? size: 1);
+
+	if (size > arena->chunkSize / 4)
+	{
+		/* A large object gets a chunk of its own, put behind the chunk
+		 * being filled. */
+		arenaChunk *large = newChunk (size);
+		large->used = size;
+		large->next = chunk->next;
+		chunk->next = large;
+		return large->data;
+	}
+
+	if (chunk->size - chunk->used < size)
+	{
+		chunk = newChunk (arena->chunkSize);
+		chunk->next = arena->chunks;
+		arena->chunks = chunk;
+	}
+
+	p = (char *) chunk->data + chunk->used;
+	chunk->used += size;
+	return p;
+}
+
+extern void *arenaCalloc (Arena *arena, size_t size)
+{
+	void *p = arenaAlloc (arena, size);
+
+	memset (p, 0, size);
+	return p;
+}
+
+extern void arenaReset (Arena *arena)
+{
+	arenaChunk *first = arena->chunks;
+	arenaChunk *chunk = first->next;
+
+	/* Keep the chunk being filled for the next objects. */
+	while (chunk)
+	{
+		arenaChunk *next = chunk->next;
+		eFree (chunk);
+		chunk = next;
+	}
+	Assert (first->size == arena->chunkSize);
+	first->next = NULL;
+	first->used = 0;
+}
@@ -0,0 +1,35 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to arena.c
+*/
+#ifndef CTAGS_MAIN_ARENA_PRIVATE_H
+#define CTAGS_MAIN_ARENA_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stddef.h>
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sArena Arena;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern Arena *arenaNew (size_t chunkSize);
+extern void arenaDelete (Arena *arena);
+extern void *arenaAlloc (Arena *arena, size_t size);
+extern void *arenaCalloc (Arena *arena, size_t size);
+
+/* Release all the objects allocated from the arena. */
+extern void arenaReset (Arena *arena);
+
+#endif  /* CTAGS_MAIN_ARENA_PRIVATE_H */
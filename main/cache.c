@@ -0,0 +1,412 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for reusing the tags made from an input
+*   file at an earlier run (--cache-dir).
+*
+*   The tags made from an input file are saved in a cache file in the cache
+*   directory, together with the key they were made for: a hash of the
+*   contents of the input file, the language, a hash of the options
+*   changing the tags, and the name of the input file. When an input file
+*   having the same key is parsed later, the saved tags are copied to the
+*   tag file instead of running the parser.
+*
+*   The parser specific pseudo tags are not saved. Where they were written
+*   is recorded instead, and they are written when the tags are copied if
+*   they have not been written yet.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#if defined (HAVE_UNISTD_H)
+# include <unistd.h>
+#endif
+#if defined (HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+#ifdef WIN32
+# include <direct.h>
+# include <process.h>
+#endif
+
+#include "cache_p.h"
+#include "debug.h"
+#include "entry_p.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse.h"
+#include "parse_p.h"
+#include "read.h"
+#include "read_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "stats_p.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define CACHE_FILE_MAGIC "!_CTAGS_CACHE\t1"
+#define CACHE_FILE_SUFFIX ".tags"
+
+/*
+*   DATA DECLARATIONS
+*/
+struct sParseCache {
+	char *name;			/* the cache file */
+	vString *key;
+
+	/* Used while capturing the tags */
+	MIO *capture;
+	MIO *tagFile;
+	void (* deferFunc) (langType, void *);
+	void *deferData;
+
+	/* Where the parser specific pseudo tags are expected */
+	intArray *languages;
+	longArray *offsets;
+
+	unsigned long numTags;
+	long lines;
+	long bytes;
+};
+
+/*
+*   DATA DEFINITIONS
+*/
+static bool CacheDirectoryReady;
+static bool CacheWriteFailed;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static bool hashInput (const char *const fileName, MIO *mio, unsigned long long *hash)
+{
+	unsigned char buffer [BUFSIZ];
+	unsigned char *data;
+	size_t size;
+	MIO *opened = NULL;
+
+	*hash = FNV_OFFSET_BASIS;
+	if (mio && (data = mio_memory_get_data (mio, &size)) != NULL)
+	{
+		*hash = hashBytes (*hash, data, size);
+		return true;
+	}
+
+	if (mio == NULL)
+	{
+		opened = mio_new_file (fileName, "rb");
+		if (opened == NULL)
+			return false;
+		mio = opened;
+	}
+	else
+		mio_rewind (mio);
+
+	while ((size = mio_read (mio, buffer, 1, sizeof (buffer))) > 0)
+		*hash = hashBytes (*hash, buffer, size);
+
+	if (opened)
+		mio_unref (opened);
+	else
+		mio_rewind (mio);
+	return true;
+}
+
+static void catHash (vString *string, unsigned long long hash)
+{
+	char hex [2 * sizeof (hash) + 1];
+
+	snprintf (hex, sizeof (hex), "%016llx", hash);
+	vStringCatS (string, hex);
+}
+
+extern parseCache *openParseCache (const char *const fileName, const langType language, MIO *mio)
+{
+	unsigned long long contentHash;
+	parseCache *cache;
+	vString *tagPath;
+	vString *name;
+
+	if (Option.cacheDir == NULL || Option.filter || Option.interactive)
+		return NULL;
+	if (! hashInput (fileName, mio, &contentHash))
+		return NULL;
+
+	cache = xCalloc (1, parseCache);
+	cache->key = vStringNew ();
+	catHash (cache->key, contentHash);
+	vStringPut (cache->key, '\t');
+	vStringCatS (cache->key, getLanguageName (language));
+	vStringPut (cache->key, '\t');
+	catHash (cache->key, getOptionsHash ());
+	vStringPut (cache->key, '\t');
+	vStringCatS (cache->key, fileName);
+	vStringPut (cache->key, '\t');
+	tagPath = makeInputFileTagPath (fileName);
+	vStringCat (cache->key, tagPath);
+	vStringDelete (tagPath);
+
+	name = vStringNewInit (Option.cacheDir);
+	vStringPut (name, '/');
+	catHash (name, hashBytes (FNV_OFFSET_BASIS, vStringValue (cache->key),
+							  vStringLength (cache->key)));
+	vStringCatS (name, CACHE_FILE_SUFFIX);
+
+	cache->name = vStringDeleteUnwrap (name);
+	cache->languages = intArrayNew ();
+	cache->offsets = longArrayNew ();
+	return cache;
+}
+
+/* Copy SIZE bytes of tags from the current position of MIO to the tag
+ * file, writing the parser specific pseudo tags where expected. */
+static void appendCachedTags (parseCache *cache, MIO *mio, long size)
+{
+	long pos = 0;
+
+	for (unsigned int i = 0; i < intArrayCount (cache->languages); i++)
+	{
+		long offset = longArrayItem (cache->offsets, i);
+		appendTagFileChunk (mio, offset - pos, 0);
+		pos = offset;
+		makeDeferredParserPseudoTags (intArrayItem (cache->languages, i));
+	}
+	appendTagFileChunk (mio, size - pos, cache->numTags);
+}
+
+static bool readCacheHeader (parseCache *cache, MIO *mio, vString *line, long *size)
+{
+	unsigned int count;
+
+	if (readLineRaw (line, mio) == NULL)
+		return false;
+	vStringStripNewline (line);
+	if (strcmp (vStringValue (line), CACHE_FILE_MAGIC) != 0)
+		return false;
+
+	if (readLineRaw (line, mio) == NULL)
+		return false;
+	vStringStripNewline (line);
+	if (strcmp (vStringValue (line), vStringValue (cache->key)) != 0)
+		return false;
+
+	if (readLineRaw (line, mio) == NULL
+		|| sscanf (vStringValue (line), "%lu\t%ld\t%ld\t%ld\t%u",
+				   &cache->numTags, &cache->lines, &cache->bytes, size, &count) != 5
+		|| *size < 0)
+		return false;
+
+	for (unsigned int i = 0; i < count; i++)
+	{
+		char *sep;
+		long offset;
+		langType language;
+
+		if (readLineRaw (line, mio) == NULL)
+			return false;
+		vStringStripNewline (line);
+		sep = strrchr (vStringValue (line), '\t');
+		if (sep == NULL || sscanf (sep + 1, "%ld", &offset) != 1)
+			return false;
+		language = getNamedLanguage (vStringValue (line), sep - vStringValue (line));
+		if (language == LANG_IGNORE
+			|| offset < (i > 0? longArrayLast (cache->offsets): 0)
+			|| offset > *size)
+			return false;
+		intArrayAdd (cache->languages, language);
+		longArrayAdd (cache->offsets, offset);
+	}
+
+	/* The rest must be the tags. */
+	long start = mio_tell (mio);
+	if (mio_seek (mio, 0, SEEK_END) != 0
+		|| mio_tell (mio) - start != *size
+		|| mio_seek (mio, start, SEEK_SET) != 0)
+		return false;
+
+	return true;
+}
+
+/* Copy the tags in the cache file to the tag file.
+ * Return false if there is no valid cache file. */
+extern bool replayParseCache (parseCache *cache)
+{
+	MIO *mio = mio_new_file (cache->name, "rb");
+	vString *line;
+	long size;
+	bool found;
+
+	if (mio == NULL)
+		return false;
+
+	line = vStringNew ();
+	found = readCacheHeader (cache, mio, line, &size);
+	vStringDelete (line);
+
+	if (found)
+	{
+		verbose ("using cached tags in %s\n", cache->name);
+		appendCachedTags (cache, mio, size);
+		addTotals (0, cache->lines, cache->bytes);
+	}
+	else
+	{
+		intArrayClear (cache->languages);
+		longArrayClear (cache->offsets);
+	}
+	mio_unref (mio);
+	return found;
+}
+
+static void deferCachedPseudoTags (langType language, void *data)
+{
+	parseCache *cache = data;
+
+	intArrayAdd (cache->languages, language);
+	longArrayAdd (cache->offsets, tagFileOffset ());
+}
+
+/* Capture the tags written to the tag file until storeParseCache(). */
+extern void captureParseCache (parseCache *cache)
+{
+	long files;
+
+	cache->capture = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+	cache->tagFile = redirectTagFile (cache->capture);
+	getParserPseudoTagsDeferral (&cache->deferFunc, &cache->deferData);
+	deferParserPseudoTags (deferCachedPseudoTags, cache);
+	cache->numTags = numTagsAdded ();
+	getTotals (&files, &cache->lines, &cache->bytes);
+}
+
+static bool prepareCacheDirectory (void)
+{
+	int r = 0;
+
+	if (CacheDirectoryReady || doesFileExist (Option.cacheDir))
+		return CacheDirectoryReady = true;
+
+#ifdef WIN32
+	r = _mkdir (Option.cacheDir);
+#elif defined (HAVE_MKDIR)
+	r = mkdir (Option.cacheDir, 0777);
+#else
+	r = -1;
+	errno = ENOENT;
+#endif
+	if (r != 0 && errno != EEXIST)
+	{
+		error (WARNING | PERROR, "cannot make cache directory \"%s\"", Option.cacheDir);
+		return false;
+	}
+	return CacheDirectoryReady = true;
+}
+
+static void writeCacheFile (parseCache *cache, long size)
+{
+	const unsigned char *tags = mio_memory_get_data (cache->capture, NULL);
+	vString *tempName;
+	MIO *mio;
+	long pid = 0;
+	bool failed;
+
+	if (CacheWriteFailed)
+		return;
+	if (! prepareCacheDirectory ())
+	{
+		CacheWriteFailed = true;
+		return;
+	}
+
+#if defined (WIN32)
+	pid = (long) _getpid ();
+#elif defined (HAVE_GETPID)
+	pid = (long) getpid ();
+#endif
+	/* Another process may be writing the same cache file. */
+	tempName = vStringNewInit (cache->name);
+	vStringCatS (tempName, ".tmp");
+	catHash (tempName, (unsigned long long) pid);
+
+	mio = mio_new_file (vStringValue (tempName), "wb");
+	if (mio == NULL)
+	{
+		error (WARNING | PERROR, "cannot open cache file \"%s\"", vStringValue (tempName));
+		CacheWriteFailed = true;
+		vStringDelete (tempName);
+		return;
+	}
+
+	mio_printf (mio, "%s\n%s\n%lu\t%ld\t%ld\t%ld\t%u\n", CACHE_FILE_MAGIC,
+				vStringValue (cache->key), cache->numTags,
+				cache->lines, cache->bytes, size,
+				intArrayCount (cache->languages));
+	for (unsigned int i = 0; i < intArrayCount (cache->languages); i++)
+		mio_printf (mio, "%s\t%ld\n",
+					getLanguageName (intArrayItem (cache->languages, i)),
+					longArrayItem (cache->offsets, i));
+	failed = (size > 0 && mio_write (mio, tags, 1, size) != (size_t) size);
+	failed = (mio_unref (mio) != 0) || failed;
+
+	if (! failed && rename (vStringValue (tempName), cache->name) != 0)
+	{
+		/* rename() doesn't replace an existing file on some platforms. */
+		remove (cache->name);
+		failed = (rename (vStringValue (tempName), cache->name) != 0);
+	}
+	if (failed)
+	{
+		error (WARNING | PERROR, "cannot write cache file \"%s\"", cache->name);
+		remove (vStringValue (tempName));
+		CacheWriteFailed = true;
+	}
+	vStringDelete (tempName);
+}
+
+/* Save the tags captured since captureParseCache() in the cache file,
+ * and copy them to the tag file. */
+extern void storeParseCache (parseCache *cache)
+{
+	long size = mio_tell (cache->capture);
+	long files, lines, bytes;
+	unsigned long numTags = numTagsAdded ();
+
+	redirectTagFile (cache->tagFile);
+	deferParserPseudoTags (cache->deferFunc, cache->deferData);
+	getTotals (&files, &lines, &bytes);
+
+	setNumTagsAdded (cache->numTags);
+	cache->numTags = numTags - cache->numTags;
+	cache->lines = lines - cache->lines;
+	cache->bytes = bytes - cache->bytes;
+
+	writeCacheFile (cache, size);
+
+	mio_rewind (cache->capture);
+	appendCachedTags (cache, cache->capture, size);
+	mio_unref (cache->capture);
+	cache->capture = NULL;
+}
+
+extern void closeParseCache (parseCache *cache)
+{
+	Assert (cache->capture == NULL);
+
+	intArrayDelete (cache->languages);
+	longArrayDelete (cache->offsets);
+	vStringDelete (cache->key);
+	eFree (cache->name);
+	eFree (cache);
+}
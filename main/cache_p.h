@@ -0,0 +1,34 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to cache.c
+*/
+#ifndef CTAGS_MAIN_CACHE_PRIVATE_H
+#define CTAGS_MAIN_CACHE_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "mio.h"
+#include "types.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sParseCache parseCache;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern parseCache *openParseCache (const char *const fileName, const langType language, MIO *mio);
+extern bool replayParseCache (parseCache *cache);
+extern void captureParseCache (parseCache *cache);
+extern void storeParseCache (parseCache *cache);
+extern void closeParseCache (parseCache *cache);
+
+#endif  /* CTAGS_MAIN_CACHE_PRIVATE_H */
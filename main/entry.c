@@ -16,33 +16,22 @@
 #include <ctype.h>        /* to define isspace () */
 #include <errno.h>
 
-#if defined (HAVE_SYS_TYPES_H)
-# include <sys/types.h>	  /* to declare off_t on some hosts */
-#endif
-#if defined (HAVE_TYPES_H)
-# include <types.h>       /* to declare off_t on some hosts */
-#endif
+#include <stdint.h>
+#include <limits.h>  /* to define INT_MAX */
+#include <stdlib.h>  /* to declare atexit () */
 #if defined (HAVE_UNISTD_H)
-# include <unistd.h>      /* to declare close (), ftruncate (), truncate () */
-#endif
-
-/*  These header files provide for the functions necessary to do file
- *  truncation.
- */
-#ifdef HAVE_FCNTL_H
-# include <fcntl.h>
+# include <unistd.h>  /* to declare getpid () */
 #endif
-#ifdef HAVE_IO_H
-# include <io.h>
+#ifdef WIN32
+# include <process.h>  /* to declare _getpid () */
 #endif
 
-#include <stdint.h>
-#include <limits.h>  /* to define INT_MAX */
-
 #include "debug.h"
 #include "entry_p.h"
 #include "field.h"
+#include "incremental_p.h"
 #include "fmt_p.h"
+#include "htable.h"
 #include "kind.h"
 #include "nestlevel.h"
 #include "options_p.h"
@@ -57,6 +46,7 @@
 #include "sort_p.h"
 #include "strlist.h"
 #include "subparser_p.h"
+#include "tagindex_p.h"
 #include "trashbox.h"
 #include "writer_p.h"
 #include "xtag_p.h"
@@ -65,21 +55,11 @@
 *   MACROS
 */
 
-/*
- *  Portability defines
- */
-#if !defined(HAVE_TRUNCATE) && !defined(HAVE_FTRUNCATE) && !defined(HAVE_CHSIZE)
-# define USE_REPLACEMENT_TRUNCATE
-#endif
-
-/*  Hack for ridiculous practice of Microsoft Visual C++.
- */
-#if defined (WIN32) && defined (_MSC_VER)
-# define chsize         _chsize
-# define open           _open
-# define close          _close
-# define O_RDWR         _O_RDWR
-#endif
+/* The size of the buffer gathering the writes to a tag file */
+#define TAG_FILE_WRITE_BUFFER_SIZE (256 * 1024)
+/* The buffer of a parser pass grown larger than this is released when the
+ * pass is committed, not to keep the memory for a large input file. */
+#define TAG_FILE_PASS_KEEP_SIZE (1024 * 1024)
 
 
 /*  Maintains the state of the tag file.
@@ -95,8 +75,26 @@ typedef struct eTagFile {
 	int cork;
 	unsigned int corkFlags;
 	ptrArray *corkQueue;
+	/* The strings shared by the tags in corkQueue, like the input file
+	 * name and the scope names. Each of them is stored only once. */
+	hashTable *corkStrings;
 
 	bool patternCacheValid;
+
+	/* The tags made at the last run (--incremental) */
+	MIO *kept;
+	char *keptName;
+	long keptOwner;		/* the process which made keptName */
+
+	/* Where the tags kept in memory are written sorted (--sort-in-memory).
+	 * mio is a memory stream then. */
+	MIO *sorted;
+
+	/* The tags of the current parser pass (see beginTagFilePass()).
+	 * mio is pass while passTarget keeps the stream they go to. */
+	MIO *pass;
+	MIO *passTarget;
+	unsigned int passDepth;
 } tagFile;
 
 typedef struct sTagEntryInfoX  {
@@ -104,6 +102,7 @@ typedef struct sTagEntryInfoX  {
 	int corkIndex;
 	struct rb_root symtab;
 	struct rb_node symnode;
+	bool inArena;	/* allocated with parserArenaAlloc () */
 } tagEntryInfoX;
 
 /*
@@ -120,21 +119,16 @@ static tagFile TagFile = {
     .cork = false,
     .corkQueue = NULL,
     .patternCacheValid = false,
+    .kept = NULL,
+    .keptName = NULL,
+    .sorted = NULL,
+    .pass = NULL,
+    .passTarget = NULL,
+    .passDepth = 0,
 };
 
 static bool TagsToStdout = false;
 
-/*
-*   FUNCTION PROTOTYPES
-*/
-#ifdef NEED_PROTO_TRUNCATE
-extern int truncate (const char *path, off_t length);
-#endif
-
-#ifdef NEED_PROTO_FTRUNCATE
-extern int ftruncate (int fd, off_t length);
-#endif
-
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -144,6 +138,11 @@ extern void freeTagFileResources (void)
 	if (TagFile.directory != NULL)
 		eFree (TagFile.directory);
 	vStringDelete (TagFile.vLine);
+	if (TagFile.pass)
+	{
+		mio_unref (TagFile.pass);
+		TagFile.pass = NULL;
+	}
 }
 
 extern const char *tagFileName (void)
@@ -376,6 +375,119 @@ static bool isTagFile (const char *const filename)
 	return ok;
 }
 
+static long getProcessId (void)
+{
+#if defined (WIN32)
+	return (long) _getpid ();
+#elif defined (HAVE_GETPID)
+	return (long) getpid ();
+#else
+	return 0;
+#endif
+}
+
+/* Don't leave the tags kept aside in the temporary directory if ctags
+ * exits on a fatal error before restoring them. A worker process forked
+ * by --jobs exiting must not remove them. */
+static void removeKeptTagFile (void)
+{
+	if (TagFile.keptName && TagFile.keptOwner == getProcessId ())
+		remove (TagFile.keptName);
+}
+
+/* Put the tags of the existing tag file aside. The pseudo tags other than
+ * parser specific ones are dropped; they are written again. */
+static void keepTagFile (void)
+{
+	static bool keptTagFileCleanupRegistered;
+	MIO *mio = mio_new_file (TagFile.name, "r");
+	const char *line;
+
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open tag file \"%s\"", TagFile.name);
+
+	TagFile.kept = tempFile ("w+", &TagFile.keptName);
+	TagFile.keptOwner = getProcessId ();
+	if (! keptTagFileCleanupRegistered)
+	{
+		atexit (removeKeptTagFile);
+		keptTagFileCleanupRegistered = true;
+	}
+	while ((line = readLineRaw (TagFile.vLine, mio)) != NULL)
+	{
+		if (line [0] == '!' && line [1] == '_')
+		{
+			const char *sep = strpbrk (line + 2, "!\t");
+			if (sep == NULL || *sep != '!')
+				continue;
+		}
+		mio_puts (TagFile.kept, line);
+	}
+	abort_if_ferror (TagFile.kept);
+	mio_unref (mio);
+}
+
+/* Return true if LINE is a parser specific pseudo tag (!_NAME!LANG) for
+ * a parser which has written its pseudo tags again in this run. */
+static bool isPseudoTagLineRewritten (const char *const line)
+{
+	const char *sep, *end;
+	langType language;
+
+	if (! (line [0] == '!' && line [1] == '_'))
+		return false;
+
+	sep = strpbrk (line + 2, "!\t");
+	if (sep == NULL || *sep != '!')
+		return false;
+	sep++;
+	end = strchr (sep, '\t');
+	if (end == NULL)
+		return false;
+
+	language = getNamedLanguage (sep, end - sep);
+	return (language != LANG_IGNORE && isParserPseudoTagPrinted (language));
+}
+
+/* Put the tags kept aside back, except the stale ones and the parser
+ * specific pseudo tags written again. */
+static void restoreTagFile (void)
+{
+	const char *line;
+
+	pruneInputStamps ();
+	mio_rewind (TagFile.kept);
+	while ((line = readLineRaw (TagFile.vLine, TagFile.kept)) != NULL)
+	{
+		if (isTagLineStale (line) || isPseudoTagLineRewritten (line))
+			continue;
+		mio_puts (TagFile.mio, line);
+		if (! (line [0] == '!' && line [1] == '_'))
+			++TagFile.numTags.prev;
+	}
+	abort_if_ferror (TagFile.mio);
+
+	mio_unref (TagFile.kept);
+	remove (TagFile.keptName);
+	eFree (TagFile.keptName);
+	TagFile.kept = NULL;
+	TagFile.keptName = NULL;
+}
+
+static bool useSortInMemory (void)
+{
+	return (bool) (Option.sortInMemory
+				   && Option.sorted != SO_UNSORTED
+				   && ! Option.etags
+				   && ! Option.append
+				   && Option.interactive != INTERACTIVE_SANDBOX);
+}
+
+static MIO *newTagMemory (void)
+{
+	return mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+}
+
 extern void openTagFile (void)
 {
 	setDefaultTagFileName ();
@@ -388,11 +500,18 @@ extern void openTagFile (void)
 	 */
 	if (TagsToStdout)
 	{
-		if (Option.interactive == INTERACTIVE_SANDBOX)
+		if (Option.interactive == INTERACTIVE_SANDBOX
+			|| (Option.server && ! useSortInMemory ()))
 		{
-			TagFile.mio = mio_new_memory (NULL, 0, eRealloc, eFreeNoNullCheck);
+			TagFile.mio = newTagMemory ();
 			TagFile.name = NULL;
 		}
+		else if (useSortInMemory ())
+		{
+			TagFile.mio = newTagMemory ();
+			TagFile.name = NULL;
+			TagFile.sorted = mio_new_fp (stdout, NULL);
+		}
 		else
 			TagFile.mio = tempFile ("w+", &TagFile.name);
 		if (isXtagEnabled (XTAG_PSEUDO_TAGS))
@@ -430,15 +549,29 @@ extern void openTagFile (void)
 			}
 			else
 			{
+				if (Option.incremental && fileExists
+					&& loadInputStamps (TagFile.name))
+					keepTagFile ();
 				TagFile.mio = mio_new_file (TagFile.name, "w");
+				if (TagFile.mio != NULL && useSortInMemory ())
+				{
+					TagFile.sorted = TagFile.mio;
+					TagFile.mio = newTagMemory ();
+				}
 				if (TagFile.mio != NULL && isXtagEnabled (XTAG_PSEUDO_TAGS))
 					addCommonPseudoTags ();
 			}
 		}
 		if (TagFile.mio == NULL)
 			error (FATAL | PERROR, "cannot open tag file");
+		if (TagFile.sorted)
+			mio_file_set_write_buffer (TagFile.sorted, TAG_FILE_WRITE_BUFFER_SIZE);
 	}
 
+	/* A tag line is written in pieces. Don't pass each of them to stdio.
+	 * This does nothing for a tag file kept in memory. */
+	mio_file_set_write_buffer (TagFile.mio, TAG_FILE_WRITE_BUFFER_SIZE);
+
 	if (TagFile.directory == NULL)
 	{
 		if (TagsToStdout)
@@ -448,64 +581,6 @@ extern void openTagFile (void)
 	}
 }
 
-#ifdef USE_REPLACEMENT_TRUNCATE
-
-static void copyBytes (MIO* const fromMio, MIO* const toMio, const long size)
-{
-	enum { BufferSize = 1000 };
-	long toRead, numRead;
-	char* buffer = xMalloc (BufferSize, char);
-	long remaining = size;
-	do
-	{
-		toRead = (0 < remaining && remaining < BufferSize) ?
-					remaining : (long) BufferSize;
-		numRead = mio_read (fromMio, buffer, (size_t) 1, (size_t) toRead);
-		if (mio_write (toMio, buffer, (size_t)1, (size_t)numRead) < (size_t)numRead)
-			error (FATAL | PERROR, "cannot complete write");
-		if (remaining > 0)
-			remaining -= numRead;
-	} while (numRead == toRead  &&  remaining != 0);
-	eFree (buffer);
-}
-
-static void copyFile (const char *const from, const char *const to, const long size)
-{
-	MIO* const fromMio = mio_new_file (from, "rb");
-	if (fromMio == NULL)
-		error (FATAL | PERROR, "cannot open file to copy");
-	else
-	{
-		MIO* const toMio = mio_new_file (to, "wb");
-		if (toMio == NULL)
-			error (FATAL | PERROR, "cannot open copy destination");
-		else
-		{
-			copyBytes (fromMio, toMio, size);
-			mio_unref (toMio);
-		}
-		mio_unref (fromMio);
-	}
-}
-
-/*  Replacement for missing library function.
- */
-static int replacementTruncate (const char *const name, const long size)
-{
-#define WHOLE_FILE  -1L
-	char *tempName = NULL;
-	MIO *mio = tempFile ("w", &tempName);
-	mio_unref (mio);
-	copyFile (name, tempName, size);
-	copyFile (tempName, name, WHOLE_FILE);
-	remove (tempName);
-	eFree (tempName);
-
-	return 0;
-}
-
-#endif
-
 #ifndef EXTERNAL_SORT
 static void internalSortTagFile (void)
 {
@@ -525,15 +600,34 @@ static void internalSortTagFile (void)
 			failedSort (mio, NULL);
 	}
 
-	internalSortTags (TagsToStdout,
-			  mio,
-			  TagFile.numTags.added + TagFile.numTags.prev);
+	internalSortTags (TagsToStdout, mio);
 
 	if (! TagsToStdout)
 		mio_unref (mio);
 }
 #endif
 
+/* Write the tags kept in memory to the tag file, sorting them once. */
+static void writeSortedTagFile (void)
+{
+	size_t size;
+	char *buffer = (char *) mio_memory_get_data (TagFile.mio, &size);
+
+	if (TagFile.numTags.added > 0L)
+	{
+		verbose ("sorting tags in memory\n");
+		sortTagsInMemory (TagFile.sorted, buffer, size);
+	}
+	else if (! TagsToStdout && mio_write (TagFile.sorted, buffer, 1, size) != size)
+		error (FATAL | PERROR, "cannot write tag file");
+
+	if (mio_unref (TagFile.sorted) != 0)
+		error (FATAL | PERROR, "cannot close tag file");
+	TagFile.sorted = NULL;
+	if (TagsToStdout)
+		fflush (stdout);
+}
+
 static void sortTagFile (void)
 {
 	if (TagFile.numTags.added > 0L)
@@ -552,43 +646,6 @@ static void sortTagFile (void)
 	}
 }
 
-static void resizeTagFile (const long newSize)
-{
-	int result;
-
-	if (!TagFile.name)
-	{
-		mio_try_resize (TagFile.mio, newSize);
-		return;
-	}
-
-#ifdef USE_REPLACEMENT_TRUNCATE
-	result = replacementTruncate (TagFile.name, newSize);
-#else
-# ifdef HAVE_TRUNCATE
-	result = truncate (TagFile.name, (off_t) newSize);
-# else
-	const int fd = open (TagFile.name, O_RDWR);
-
-	if (fd == -1)
-		result = -1;
-	else
-	{
-#  ifdef HAVE_FTRUNCATE
-		result = ftruncate (fd, (off_t) newSize);
-#  else
-#   ifdef HAVE_CHSIZE
-		result = chsize (fd, newSize);
-#   endif
-#  endif
-		close (fd);
-	}
-# endif
-#endif
-	if (result == -1)
-		fprintf (stderr, "Cannot shorten tag file: errno = %d\n", errno);
-}
-
 static void writeEtagsIncludes (MIO *const mio)
 {
 	if (Option.etagsInclude)
@@ -602,36 +659,34 @@ static void writeEtagsIncludes (MIO *const mio)
 	}
 }
 
-extern void closeTagFile (const bool resize)
+extern void closeTagFile (void)
 {
-	long desiredSize, size;
+	const bool inMemory = (TagFile.sorted != NULL);
 
 	if (Option.etags)
 		writeEtagsIncludes (TagFile.mio);
+	if (TagFile.kept)
+		restoreTagFile ();
+	if (Option.incremental)
+		saveInputStamps (TagFile.name);
 	mio_flush (TagFile.mio);
 
 	abort_if_ferror (TagFile.mio);
-	desiredSize = mio_tell (TagFile.mio);
-	mio_seek (TagFile.mio, 0L, SEEK_END);
-	size = mio_tell (TagFile.mio);
-	if (! TagsToStdout)
-		/* The tag file should be closed before resizing. */
+	if (! TagsToStdout && ! inMemory)
 		if (mio_unref (TagFile.mio) != 0)
 			error (FATAL | PERROR, "cannot close tag file");
 
-	if (resize  &&  desiredSize < size)
-	{
-		DebugStatement (
-			debugPrintf (DEBUG_STATUS, "shrinking %s from %ld to %ld bytes\n",
-				TagFile.name? TagFile.name: "<mio>", size, desiredSize); )
-		resizeTagFile (desiredSize);
-	}
-	sortTagFile ();
-	if (TagsToStdout)
+	if (inMemory)
+		writeSortedTagFile ();
+	else
+		sortTagFile ();
+	if (Option.tagIndex && ! TagsToStdout)
+		writeTagIndex (TagFile.name);
+	if (TagsToStdout || inMemory)
 	{
 		if (mio_unref (TagFile.mio) != 0)
 			error (FATAL | PERROR, "cannot close tag file");
-		if (TagFile.name)
+		if (TagsToStdout && TagFile.name)
 			remove (TagFile.name);  /* remove temporary file */
 	}
 
@@ -800,6 +855,18 @@ static char* getFullQualifiedScopeNameFromCorkQueue (const tagEntryInfo * inner_
 	return vStringDeleteUnwrap (n);
 }
 
+static const char *internCorkString (const char *str)
+{
+	char *interned = hashTableGetItem (TagFile.corkStrings, str);
+
+	if (interned == NULL)
+	{
+		interned = eStrdup (str);
+		hashTablePutItem (TagFile.corkStrings, interned, interned);
+	}
+	return interned;
+}
+
 extern void getTagScopeInformation (tagEntryInfo *const tag,
 				    const char **kind, const char **name)
 {
@@ -820,7 +887,8 @@ extern void getTagScopeInformation (tagEntryInfo *const tag,
 		/* Make the information reusable to generate full qualified entry, and xformat output*/
 		tag->extensionFields.scopeLangType = scope->langType;
 		tag->extensionFields.scopeKindIndex = scope->kindIndex;
-		tag->extensionFields.scopeName = full_qualified_scope_name;
+		tag->extensionFields.scopeName = internCorkString (full_qualified_scope_name);
+		eFree (full_qualified_scope_name);
 	}
 
 	if (tag->extensionFields.scopeKindIndex != KIND_GHOST_INDEX  &&
@@ -848,11 +916,12 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 {
 	int length = 0;
 
-	char *line;
+	const char *line = NULL;
 	int searchChar;
 	const char *terminator;
 	bool  omitted;
 	size_t line_len;
+	bool from_vline = false;
 
 	bool making_cache = false;
 	int (* puts_o_func)(const char* , void *);
@@ -865,22 +934,35 @@ static int   makePatternStringCommon (const tagEntryInfo *const tag,
 	    && (memcmp (&tag->filePosition, &cached_location, sizeof(MIOPos)) == 0))
 		return puts_func (vStringValue (cached_pattern), output);
 
-	line = readLineFromBypassForTag (TagFile.vLine, tag, NULL);
+	/* Slicing the line out of the input saves reading it again, unless
+	   the line must be truncated in place. */
+	if (! tag->truncateLineAfterTag)
+		line = getInputLineFromBypass (tag->filePosition, tag->lineNumber, &line_len);
+
 	if (line == NULL)
 	{
-		/* This can be occurs if the size of input file is zero, and
-		   an empty regex pattern (//) matches to the input. */
-		line = "";
-		line_len = 0;
+		line = readLineFromBypassForTag (TagFile.vLine, tag, NULL);
+		if (line == NULL)
+		{
+			/* This can be occurs if the size of input file is zero, and
+			   an empty regex pattern (//) matches to the input. */
+			line = "";
+			line_len = 0;
+		}
+		else
+		{
+			line_len = vStringLength (TagFile.vLine);
+			from_vline = true;
+		}
 	}
-	else
-		line_len = vStringLength (TagFile.vLine);
 
-	if (tag->truncateLineAfterTag)
+	/* Only a line read into TagFile.vLine can be truncated. */
+	if (tag->truncateLineAfterTag && from_vline)
 	{
 		size_t truncted_len;
 
-		truncted_len = truncateTagLineAfterTag (line, tag->name, false);
+		truncted_len = truncateTagLineAfterTag (vStringValue (TagFile.vLine),
+												tag->name, false);
 		if (truncted_len > 0)
 			line_len = truncted_len;
 	}
@@ -973,10 +1055,10 @@ extern void attachParserField (tagEntryInfo *const tag, bool inCorkQueue, fieldT
 	if (inCorkQueue)
 	{
 		const char * v;
-		v = eStrdup (value);
+		v = internCorkString (value);
 
 		bool dynfields_allocated = tag->parserFieldsDynamic? true: false;
-		attachParserFieldGeneric (tag, ftype, v, true);
+		attachParserFieldGeneric (tag, ftype, v, false);
 		if (!dynfields_allocated && tag->parserFieldsDynamic)
 			PARSER_TRASH_BOX_TAKE_BACK(tag->parserFieldsDynamic);
 	}
@@ -1030,19 +1112,37 @@ static void copyParserFields (const tagEntryInfo *const tag, tagEntryInfo* slot)
 
 		value = f->value;
 		if (value)
-			value = eStrdup (value);
+			value = internCorkString (value);
 
 		attachParserFieldGeneric (slot,
 								  f->ftype,
 								  value,
-								  true);
+								  false);
 	}
 
 }
 
+static tagEntryInfoX *allocTagEntryInfoX (void)
+{
+	tagEntryInfoX *x = parserArenaAlloc (sizeof (tagEntryInfoX));
+
+	if (x)
+		x->inArena = true;
+	else
+	{
+		x = xMalloc (1, tagEntryInfoX);
+		x->inArena = false;
+	}
+	return x;
+}
+
 static tagEntryInfo *newNilTagEntry (unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xCalloc (1, tagEntryInfoX);
+	tagEntryInfoX *x = allocTagEntryInfoX ();
+	bool inArena = x->inArena;
+
+	memset (x, 0, sizeof (*x));
+	x->inArena = inArena;
 	x->corkIndex = CORK_NIL;
 	x->symtab = RB_ROOT;
 	x->slot.kindIndex = KIND_FILE_INDEX;
@@ -1052,7 +1152,7 @@ static tagEntryInfo *newNilTagEntry (unsigned int corkFlags)
 static tagEntryInfoX *copyTagEntry (const tagEntryInfo *const tag,
 								   unsigned int corkFlags)
 {
-	tagEntryInfoX *x = xMalloc (1, tagEntryInfoX);
+	tagEntryInfoX *x = allocTagEntryInfoX ();
 	x->symtab = RB_ROOT;
 	x->corkIndex = CORK_NIL;
 	tagEntryInfo  *slot = (tagEntryInfo *)x;
@@ -1062,18 +1162,21 @@ static tagEntryInfoX *copyTagEntry (const tagEntryInfo *const tag,
 	if (slot->pattern)
 		slot->pattern = eStrdup (slot->pattern);
 
-	slot->inputFileName = eStrdup (slot->inputFileName);
+	/* Parsers may replace the name, the signature, the inheritance, and
+	 * the typerefs of a tag in the cork queue; the tag owns them. The other
+	 * strings are interned. */
+	slot->inputFileName = internCorkString (slot->inputFileName);
 	slot->name = eStrdup (slot->name);
 	if (slot->extensionFields.access)
-		slot->extensionFields.access = eStrdup (slot->extensionFields.access);
+		slot->extensionFields.access = internCorkString (slot->extensionFields.access);
 	if (slot->extensionFields.fileScope)
-		slot->extensionFields.fileScope = eStrdup (slot->extensionFields.fileScope);
+		slot->extensionFields.fileScope = internCorkString (slot->extensionFields.fileScope);
 	if (slot->extensionFields.implementation)
-		slot->extensionFields.implementation = eStrdup (slot->extensionFields.implementation);
+		slot->extensionFields.implementation = internCorkString (slot->extensionFields.implementation);
 	if (slot->extensionFields.inheritance)
 		slot->extensionFields.inheritance = eStrdup (slot->extensionFields.inheritance);
 	if (slot->extensionFields.scopeName)
-		slot->extensionFields.scopeName = eStrdup (slot->extensionFields.scopeName);
+		slot->extensionFields.scopeName = internCorkString (slot->extensionFields.scopeName);
 	if (slot->extensionFields.signature)
 		slot->extensionFields.signature = eStrdup (slot->extensionFields.signature);
 	if (slot->extensionFields.typeRef[0])
@@ -1093,7 +1196,7 @@ static tagEntryInfoX *copyTagEntry (const tagEntryInfo *const tag,
 	}
 
 	if (slot->sourceFileName)
-		slot->sourceFileName = eStrdup (slot->sourceFileName);
+		slot->sourceFileName = internCorkString (slot->sourceFileName);
 
 
 	slot->usedParserFields = 0;
@@ -1139,19 +1242,10 @@ static void deleteTagEnry (void *data)
 
 	if (slot->pattern)
 		eFree ((char *)slot->pattern);
-	eFree ((char *)slot->inputFileName);
 	eFree ((char *)slot->name);
 
-	if (slot->extensionFields.access)
-		eFree ((char *)slot->extensionFields.access);
-	if (slot->extensionFields.fileScope)
-		eFree ((char *)slot->extensionFields.fileScope);
-	if (slot->extensionFields.implementation)
-		eFree ((char *)slot->extensionFields.implementation);
 	if (slot->extensionFields.inheritance)
 		eFree ((char *)slot->extensionFields.inheritance);
-	if (slot->extensionFields.scopeName)
-		eFree ((char *)slot->extensionFields.scopeName);
 	if (slot->extensionFields.signature)
 		eFree ((char *)slot->extensionFields.signature);
 	if (slot->extensionFields.typeRef[0])
@@ -1166,13 +1260,11 @@ static void deleteTagEnry (void *data)
 	if (slot->extraDynamic)
 		eFree (slot->extraDynamic);
 
-	if (slot->sourceFileName)
-		eFree ((char *)slot->sourceFileName);
-
 	clearParserFields (slot);
 
  out:
-	eFree (slot);
+	if (! ((tagEntryInfoX *)slot)->inArena)
+		eFree (slot);
 }
 
 static void corkSymtabPut (tagEntryInfoX *scope, const char* name, tagEntryInfoX *item)
@@ -1459,9 +1551,9 @@ extern void setupWriter (void *writerClientData)
 	writerSetup (TagFile.mio, writerClientData);
 }
 
-extern bool teardownWriter (const char *filename)
+extern void teardownWriter (const char *filename)
 {
-	return writerTeardown (TagFile.mio, filename);
+	writerTeardown (TagFile.mio, filename);
 }
 
 static bool isTagWritable(const tagEntryInfo *const tag)
@@ -1592,6 +1684,8 @@ extern void corkTagFile(unsigned int corkFlags)
 	{
 		TagFile.corkFlags = corkFlags;
 		TagFile.corkQueue = ptrArrayNew (deleteTagEnry);
+		TagFile.corkStrings = hashTableNew (256, hashCstrhash, hashCstreq,
+											eFree, NULL);
 		tagEntryInfo *nil = newNilTagEntry (corkFlags);
 		ptrArrayAdd (TagFile.corkQueue, nil);
 	}
@@ -1630,6 +1724,8 @@ extern void uncorkTagFile(void)
 
 	ptrArrayDelete (TagFile.corkQueue);
 	TagFile.corkQueue = NULL;
+	hashTableDelete (TagFile.corkStrings);
+	TagFile.corkStrings = NULL;
 }
 
 extern tagEntryInfo *getEntryInCorkQueue   (int n)
@@ -2021,6 +2117,99 @@ extern void setTagFilePosition (MIOPos *p)
 			   "failed to set file position of the tag file\n");
 }
 
+/* Make the tags written until commitTagFilePass() go to a memory buffer.
+ * A parser pass that fails and rescans its input rewinds the buffer with
+ * setTagFilePosition(), so the tag file itself is only appended to.
+ * Passes don't nest: forcePromises() runs the pass of each promise after
+ * the pass of the host parser is committed, so the tags of a promise are
+ * buffered and committed on their own. passDepth only keeps a nested
+ * call, if any, from taking over the buffer. */
+extern void beginTagFilePass (void)
+{
+	/* mini-geany doesn't set TagFile.mio. */
+	if (TagFile.passDepth++ > 0 || TagFile.mio == NULL)
+		return;
+
+	if (TagFile.pass == NULL)
+		TagFile.pass = newTagMemory ();
+	TagFile.passTarget = TagFile.mio;
+	TagFile.mio = TagFile.pass;
+}
+
+extern void commitTagFilePass (void)
+{
+	unsigned char *tags;
+	size_t size;
+	size_t allocated;
+
+	Assert (TagFile.passDepth > 0);
+	if (--TagFile.passDepth > 0 || TagFile.passTarget == NULL)
+		return;
+
+	/* What is after the position is garbage left by a failed pass. */
+	size = (size_t) mio_tell (TagFile.pass);
+	tags = mio_memory_get_data (TagFile.pass, &allocated);
+	TagFile.mio = TagFile.passTarget;
+	TagFile.passTarget = NULL;
+	if (size > 0 && mio_write (TagFile.mio, tags, 1, size) != size)
+		error (FATAL | PERROR, "cannot write tag file");
+
+	if (allocated > TAG_FILE_PASS_KEEP_SIZE)
+	{
+		mio_unref (TagFile.pass);
+		TagFile.pass = NULL;
+	}
+	else
+		mio_rewind (TagFile.pass);
+}
+
+/* Return the offset in the stream the tags go to at which the next tag
+ * will be, counting the tags of the current parser pass. */
+extern long tagFileOffset (void)
+{
+	if (TagFile.passTarget)
+		return mio_tell (TagFile.passTarget) + mio_tell (TagFile.pass);
+	return mio_tell (TagFile.mio);
+}
+
+/* Make the tags written after this call go to MIO instead of the tag file.
+ * The previously used stream is returned. */
+extern MIO *redirectTagFile (MIO *mio)
+{
+	MIO *old = TagFile.mio;
+	TagFile.mio = mio;
+	return old;
+}
+
+extern void flushTagFile (void)
+{
+	if (TagFile.mio)
+	{
+		mio_flush (TagFile.mio);
+		abort_if_ferror (TagFile.mio);
+	}
+}
+
+/* Copy SIZE bytes of tag lines, NTAGS tags, from the current position of
+ * MIO to the tag file. */
+extern void appendTagFileChunk (MIO *mio, long size, unsigned long ntags)
+{
+	char buffer [BUFSIZ];
+
+	while (size > 0)
+	{
+		size_t want = size < (long) sizeof (buffer)? (size_t) size: sizeof (buffer);
+		size_t got = mio_read (mio, buffer, 1, want);
+		if (got == 0)
+			error (FATAL | PERROR, "cannot read tags to be merged");
+		mio_write (TagFile.mio, buffer, 1, got);
+		size -= got;
+	}
+	abort_if_ferror (TagFile.mio);
+
+	TagFile.numTags.added += ntags;
+}
+
 extern const char* getTagFileDirectory (void)
 {
 	return TagFile.directory;
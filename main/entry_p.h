@@ -29,9 +29,9 @@ extern const roleDefinition* getTagRole(const tagEntryInfo *const tag, int roleI
 extern void freeTagFileResources (void);
 extern const char *tagFileName (void);
 extern void openTagFile (void);
-extern void closeTagFile (const bool resize);
+extern void closeTagFile (void);
 extern void  setupWriter (void *writerClientData);
-extern bool  teardownWriter (const char *inputFilename);
+extern void  teardownWriter (const char *inputFilename);
 
 extern unsigned long numTagsAdded(void);
 extern void setNumTagsAdded (unsigned long nadded);
@@ -40,6 +40,12 @@ extern unsigned long maxTagsLine(void);
 extern void invalidatePatternCache(void);
 extern void tagFilePosition (MIOPos *p);
 extern void setTagFilePosition (MIOPos *p);
+extern void beginTagFilePass (void);
+extern void commitTagFilePass (void);
+extern long tagFileOffset (void);
+extern MIO *redirectTagFile (MIO *mio);
+extern void flushTagFile (void);
+extern void appendTagFileChunk (MIO *mio, long size, unsigned long ntags);
 extern const char* getTagFileDirectory (void);
 extern void getTagScopeInformation (tagEntryInfo *const tag,
 				    const char **kind, const char **name);
@@ -547,13 +547,13 @@ static const char *renderFieldTyperef (const tagEntryInfo *const tag, const char
 }
 
 
-static const char* renderFieldCommon (fieldType type,
-									  const tagEntryInfo *tag,
-									  int index,
-									  bool noEscaping)
+static fieldRenderer getFieldRenderer (fieldType type,
+									   const tagEntryInfo *tag,
+									   int index,
+									   bool noEscaping,
+									   const char **value)
 {
 	fieldObject *fobj = fieldObjects + type;
-	const char *value;
 	fieldRenderer rfn;
 
 	Assert (tag);
@@ -563,10 +563,10 @@ static const char* renderFieldCommon (fieldType type,
 	{
 		const tagField *f = getParserFieldForIndex (tag, index);
 
-		value = f->value;
+		*value = f->value;
 	}
 	else
-		value = NULL;
+		*value = NULL;
 
 	if (noEscaping)
 		rfn = fobj->def->renderNoEscaping;
@@ -574,6 +574,18 @@ static const char* renderFieldCommon (fieldType type,
 		rfn = fobj->def->render;
 	Assert (rfn);
 
+	return rfn;
+}
+
+static const char* renderFieldCommon (fieldType type,
+									  const tagEntryInfo *tag,
+									  int index,
+									  bool noEscaping)
+{
+	fieldObject *fobj = fieldObjects + type;
+	const char *value;
+	fieldRenderer rfn = getFieldRenderer (type, tag, index, noEscaping, &value);
+
 	fobj->buffer = vStringNewOrClearWithAutoRelease (fobj->buffer);
 	return rfn (tag, value, fobj->buffer);
 }
@@ -588,6 +600,29 @@ extern const char* renderFieldNoEscaping (fieldType type, const tagEntryInfo *ta
 	return renderFieldCommon (type, tag, index, true);
 }
 
+extern bool renderFieldIntoBuffer (fieldType type, const tagEntryInfo *tag, int index,
+								   bool noEscaping, vString *buffer)
+{
+	const char *value;
+	fieldRenderer rfn = getFieldRenderer (type, tag, index, noEscaping, &value);
+	size_t length = vStringLength (buffer);
+	const char *r;
+
+	/* A renderer appends its output to the buffer given, or returns
+	 * a string not in the buffer. */
+	r = rfn (tag, value, buffer);
+	Assert (vStringLength (buffer) >= length);
+
+	if (r == NULL)
+	{
+		vStringTruncate (buffer, length);
+		return false;
+	}
+	else if (r != vStringValue (buffer))
+		vStringCatS (buffer, r);
+	return true;
+}
+
 static bool defaultDoesContainAnyChar (const tagEntryInfo *const tag CTAGS_ATTR_UNUSED, const char* value, const char* chars)
 {
 	return strpbrk (value, chars)? true: false;
@@ -678,14 +713,11 @@ static const char *renderFieldCompactInputLine (const tagEntryInfo *const tag,
 	line = readLineFromBypassForTag (tmp, tag, NULL);
 	if (line)
 		renderCompactInputLine (b, line);
-	else
-	{
-		/* If no associated line for tag is found, we cannot prepare
-		 * parameter to writeCompactInputLine(). In this case we
-		 * use an empty string as LINE.
-		 */
-		vStringClear (b);
-	}
+
+	/* If no associated line for tag is found, we cannot prepare
+	 * parameter to writeCompactInputLine(). In this case we
+	 * use an empty string as LINE.
+	 */
 
 	return vStringValue (b);
 }
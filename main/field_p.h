@@ -60,6 +60,12 @@ extern bool doesFieldHaveValue (fieldType type, const tagEntryInfo *tag);
 
 extern const char* renderField (fieldType type, const tagEntryInfo *tag, int index);
 extern const char* renderFieldNoEscaping (fieldType type, const tagEntryInfo *tag, int index);
+
+/* Append the rendered value to BUFFER instead of returning it.
+ * Return false if the field has nothing to render. */
+extern bool renderFieldIntoBuffer (fieldType type, const tagEntryInfo *tag, int index,
+								   bool noEscaping, vString *buffer);
+
 extern bool  doesFieldHaveTabOrNewlineChar (fieldType type, const tagEntryInfo *tag, int index);
 
 extern void initFieldObjects (void);
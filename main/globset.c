@@ -0,0 +1,261 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for matching a file name against a set
+*   of fnmatch(3) patterns at once. The patterns are sorted out when they
+*   are added:
+*
+*     "name"     names having no wildcard; looked up in a hash table
+*     "xxx*"     prefixes; looked up in a hash table for each length of them
+*     "*xxx"     suffixes (e.g. extensions like "*.o"); ditto
+*     others     tried with fnmatch(3) one by one
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <string.h>
+#include <fnmatch.h>
+
+#include "debug.h"
+#include "globset_p.h"
+#include "htable.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sAffixTable {
+	hashTable *table;
+	size_t *lengths;			/* the distinct lengths of the keys */
+	unsigned int count;
+	unsigned int allocated;
+} affixTable;
+
+struct sGlobSet {
+	hashTable *names;
+	affixTable prefixes;
+	affixTable suffixes;
+	stringList *globs;
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static hashTable *newKeyTable (void)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return hashTableNew (64, hashCstrcasehash, hashCstrcaseeq, eFree, NULL);
+#else
+	return hashTableNew (64, hashCstrhash, hashCstreq, eFree, NULL);
+#endif
+}
+
+static void addKey (hashTable *table, const char *const key, size_t len)
+{
+	char *k = eStrndup (key, len);
+
+	if (hashTableHasItem (table, k))
+		eFree (k);
+	else
+		hashTablePutItem (table, k, k);
+}
+
+static void addAffix (affixTable *affixes, const char *const affix, size_t len)
+{
+	unsigned int i;
+
+	addKey (affixes->table, affix, len);
+
+	for (i = 0; i < affixes->count; i++)
+		if (affixes->lengths [i] == len)
+			return;
+
+	if (affixes->count == affixes->allocated)
+	{
+		affixes->allocated = affixes->allocated? affixes->allocated * 2: 8;
+		affixes->lengths = xRealloc (affixes->lengths, affixes->allocated, size_t);
+	}
+	affixes->lengths [affixes->count++] = len;
+}
+
+extern globSet *globSetNew (void)
+{
+	globSet *set = xCalloc (1, globSet);
+
+	set->names = newKeyTable ();
+	set->prefixes.table = newKeyTable ();
+	set->suffixes.table = newKeyTable ();
+	set->globs = stringListNew ();
+	return set;
+}
+
+extern globSet *globSetNewFromList (const stringList *const patterns)
+{
+	globSet *set = globSetNew ();
+
+	for (unsigned int i = 0; i < stringListCount (patterns); i++)
+		globSetAdd (set, vStringValue (stringListItem (patterns, i)));
+	return set;
+}
+
+extern void globSetDelete (globSet *set)
+{
+	hashTableDelete (set->names);
+	hashTableDelete (set->prefixes.table);
+	if (set->prefixes.lengths)
+		eFree (set->prefixes.lengths);
+	hashTableDelete (set->suffixes.table);
+	if (set->suffixes.lengths)
+		eFree (set->suffixes.lengths);
+	stringListDelete (set->globs);
+	eFree (set);
+}
+
+extern globType globClassify (const char *const pattern,
+							  size_t *keyOffset, size_t *keyLength)
+{
+	static const char *const wildcards = "*?[\\";
+	const size_t len = strlen (pattern);
+	const size_t n = strcspn (pattern, wildcards);
+
+	*keyOffset = 0;
+	*keyLength = len;
+
+	if (n == len)
+		return GLOB_NAME;
+	else if (n == len - 1 && pattern [n] == '*')
+	{
+		*keyLength = n;
+		return GLOB_PREFIX;
+	}
+	else if (n == 0 && pattern [0] == '*'
+			 && strcspn (pattern + 1, wildcards) == len - 1)
+	{
+		*keyOffset = 1;
+		*keyLength = len - 1;
+		return GLOB_SUFFIX;
+	}
+	return GLOB_FNMATCH;
+}
+
+extern char *globNewFoldedKey (const char *const str, size_t len)
+{
+	char *key = eStrndup (str, len);
+#ifdef CASE_INSENSITIVE_FILENAMES
+	toUpperString (key);
+#endif
+	return key;
+}
+
+extern const char *globFoldName (const char *const fileName)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	static vString *upper;
+	upper = vStringNewOrClearWithAutoRelease (upper);
+	vStringCatS (upper, fileName);
+	vStringUpper (upper);
+	return vStringValue (upper);
+#else
+	return fileName;
+#endif
+}
+
+extern void globSetAdd (globSet *set, const char *const pattern)
+{
+	size_t offset, len;
+
+	switch (globClassify (pattern, &offset, &len))
+	{
+	case GLOB_NAME:
+		addKey (set->names, pattern, len);
+		break;
+	case GLOB_PREFIX:
+		addAffix (&set->prefixes, pattern + offset, len);
+		break;
+	case GLOB_SUFFIX:
+		addAffix (&set->suffixes, pattern + offset, len);
+		break;
+	case GLOB_FNMATCH:
+		stringListAdd (set->globs,
+					   vStringNewOwn (globNewFoldedKey (pattern + offset, len)));
+		break;
+	}
+}
+
+static bool prefixMatched (const affixTable *prefixes, const char *const fileName, size_t len)
+{
+	static vString *prefix;
+
+	if (prefixes->count == 0)
+		return false;
+
+	prefix = vStringNewOrClearWithAutoRelease (prefix);
+	for (unsigned int i = 0; i < prefixes->count; i++)
+	{
+		if (prefixes->lengths [i] > len)
+			continue;
+		vStringNCopyS (prefix, fileName, prefixes->lengths [i]);
+		if (hashTableHasItem (prefixes->table, vStringValue (prefix)))
+			return true;
+	}
+	return false;
+}
+
+static bool suffixMatched (const affixTable *suffixes, const char *const fileName, size_t len)
+{
+	for (unsigned int i = 0; i < suffixes->count; i++)
+	{
+		if (suffixes->lengths [i] > len)
+			continue;
+		if (hashTableHasItem (suffixes->table, fileName + len - suffixes->lengths [i]))
+			return true;
+	}
+	return false;
+}
+
+static bool globMatched (const stringList *globs, const char *const fileName)
+{
+	const char *name;
+
+	if (stringListCount (globs) == 0)
+		return false;
+
+	name = globFoldName (fileName);
+
+	for (unsigned int i = 0; i < stringListCount (globs); i++)
+		if (fnmatch (vStringValue (stringListItem (globs, i)), name, 0) == 0)
+			return true;
+	return false;
+}
+
+extern bool globSetMatched (const globSet *set, const char *const fileName)
+{
+	const char *name = fileName;
+	size_t len;
+	bool r;
+
+#if defined (WIN32)
+	vString *tmp = vStringNewInit (fileName);
+	vStringTranslate (tmp, PATH_SEPARATOR, OUTPUT_PATH_SEPARATOR);
+	name = vStringValue (tmp);
+#endif
+
+	len = strlen (name);
+	r = (hashTableHasItem (set->names, name)
+		 || suffixMatched (&set->suffixes, name, len)
+		 || prefixMatched (&set->prefixes, name, len)
+		 || globMatched (set->globs, name));
+
+#if defined (WIN32)
+	vStringDelete (tmp);
+#endif
+	return r;
+}
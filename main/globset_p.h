@@ -0,0 +1,58 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to globset.c
+*/
+#ifndef CTAGS_MAIN_GLOBSET_PRIVATE_H
+#define CTAGS_MAIN_GLOBSET_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "strlist.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sGlobSet globSet;
+
+/* How a pattern is matched. See globClassify (). */
+typedef enum eGlobType {
+	GLOB_NAME,					/* no wildcard; matches a file name as a whole */
+	GLOB_PREFIX,				/* "xxx*" */
+	GLOB_SUFFIX,				/* "*xxx" */
+	GLOB_FNMATCH,				/* any other pattern */
+} globType;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern globSet *globSetNew (void);
+extern globSet *globSetNewFromList (const stringList *const patterns);
+extern void globSetDelete (globSet *set);
+extern void globSetAdd (globSet *set, const char *const pattern);
+
+/* Return true if any pattern in SET matches FILENAME as fnmatch(3) does
+ * with no flag. This is what stringListFileMatched () returns. */
+extern bool globSetMatched (const globSet *set, const char *const fileName);
+
+/* Sort PATTERN out. *KEYOFFSET and *KEYLENGTH tell the part of PATTERN
+ * to compare with a file name: "xxx" for GLOB_PREFIX and GLOB_SUFFIX,
+ * and the whole PATTERN for the others. */
+extern globType globClassify (const char *const pattern,
+							  size_t *keyOffset, size_t *keyLength);
+
+/* Return a copy of LEN bytes of STR, upper-cased if file names are case
+ * insensitive on the platform. Compare it with globFoldName (). */
+extern char *globNewFoldedKey (const char *const str, size_t len);
+
+/* Return FILENAME, or its upper-cased copy if file names are case
+ * insensitive. The copy is valid until the next call. */
+extern const char *globFoldName (const char *const fileName);
+
+#endif  /* CTAGS_MAIN_GLOBSET_PRIVATE_H */
@@ -31,101 +31,129 @@
 #include <string.h>
 
 
+/* The table uses open addressing with linear probing. Entries for the
+ * same key are kept in the order they are put along the probe sequence;
+ * the last one is the first occurrence for hashTableGetItem(). An entry
+ * is deleted by shifting the following entries back, so no tombstone is
+ * needed. */
 typedef struct sHashEntry hentry;
 struct sHashEntry {
 	void *key;
 	void *value;
-	hentry *next;
+	unsigned int hash;			/* mixed hash value of key */
+	bool used;
 };
 
 struct sHashTable {
-	hentry** table;
-	unsigned int size;
+	hentry* table;
+	unsigned int size;			/* a power of 2 */
+	unsigned int count;
 	hashTableHashFunc hashfn;
 	hashTableEqualFunc equalfn;
 	hashTableFreeFunc keyfreefn;
 	hashTableFreeFunc valfreefn;
 };
 
-struct chainTracker {
-	const void *const target_key;
-	hashTableForeachFunc user_proc;
-	void *user_data;
-	hashTableEqualFunc equalfn;
-};
+#define HTABLE_MIN_SIZE 8
 
-static hentry* entry_new (void *key, void *value, hentry* next)
+/* Spread the bits of a hash value; hashPtrhash() returns aligned values,
+ * and only the low bits select a slot. */
+static unsigned int hash_mix (unsigned int h)
 {
-	hentry* entry = xMalloc (1, hentry);
-
-	entry->key = key;
-	entry->value = value;
-	entry->next = next;
-
-	return entry;
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return h;
 }
 
-static hentry* entry_destroy (hentry* entry,
-			      hashTableFreeFunc keyfreefn,
-			      hashTableFreeFunc valfreefn)
+static unsigned int key_hash (hashTable *htable, const void *key)
 {
-	hentry* tmp;
-
-	if (keyfreefn)
-		keyfreefn (entry->key);
-	if (valfreefn)
-		valfreefn (entry->value);
-	entry->key = NULL;
-	entry->value = NULL;
-	tmp = entry->next;
-	eFree (entry);
-
-	return tmp;
+	return hash_mix (htable->hashfn (key));
 }
 
-static void  entry_reclaim (hentry* entry,
-			    hashTableFreeFunc keyfreefn,
-			    hashTableFreeFunc valfreefn)
+static void entry_insert (hentry *table, unsigned int size,
+			  void *key, void *value, unsigned int hash)
 {
-	while (entry)
-		entry = entry_destroy (entry, keyfreefn, valfreefn);
+	const unsigned int mask = size - 1;
+	unsigned int i;
+
+	for (i = hash & mask; table[i].used; i = (i + 1) & mask)
+		;
+	table[i].key = key;
+	table[i].value = value;
+	table[i].hash = hash;
+	table[i].used = true;
 }
 
-static void *entry_find (hentry* entry, const void* const key, hashTableEqualFunc equalfn)
+static void table_grow (hashTable *htable)
 {
-	while (entry)
+	const unsigned int mask = htable->size - 1;
+	hentry *old = htable->table;
+	unsigned int start, i;
+
+	/* Start at an empty entry so that each run of entries is put again
+	 * in the order of probing. */
+	for (start = 0; old[start].used; start++)
+		;
+
+	htable->table = xCalloc (htable->size * 2, hentry);
+	for (i = 0; i < htable->size; i++)
 	{
-		if (equalfn( key, entry->key))
-			return entry->value;
-		entry = entry->next;
+		hentry *entry = old + ((start + i) & mask);
+		if (entry->used)
+			entry_insert (htable->table, htable->size * 2,
+				      entry->key, entry->value, entry->hash);
 	}
-	return NULL;
+	htable->size *= 2;
+	eFree (old);
 }
 
-static bool		entry_delete (hentry **entry, const void *key, hashTableEqualFunc equalfn,
-			      hashTableFreeFunc keyfreefn, hashTableFreeFunc valfreefn)
+/* Return the index of the last entry for key in the probe sequence,
+ * or -1. */
+static long entry_find (hashTable *htable, const void* const key, unsigned int hash)
 {
-	while (*entry)
-	{
-		if (equalfn (key, (*entry)->key))
-		{
-			*entry = entry_destroy (*entry, keyfreefn, valfreefn);
-			return true;
-		}
+	const unsigned int mask = htable->size - 1;
+	long found = -1;
+	unsigned int i;
 
+	for (i = hash & mask; htable->table[i].used; i = (i + 1) & mask)
+	{
+		hentry *entry = htable->table + i;
+		if (entry->hash == hash && htable->equalfn (key, entry->key))
+			found = i;
 	}
-	return false;
+	return found;
 }
 
-static bool  entry_foreach (hentry *entry, hashTableForeachFunc proc, void *user_data)
+static void entry_remove (hashTable *htable, unsigned int i)
 {
-	while (entry)
+	const unsigned int mask = htable->size - 1;
+	hentry *table = htable->table;
+	unsigned int j = i;
+
+	while (true)
 	{
-		if (!proc (entry->key, entry->value, user_data))
-			return false;
-		entry = entry->next;
+		unsigned int home;
+
+		j = (j + 1) & mask;
+		if (!table[j].used)
+			break;
+
+		/* Move the entry at j back to i unless i is before its home. */
+		home = table[j].hash & mask;
+		if (((j - home) & mask) >= ((j - i) & mask))
+		{
+			table[i] = table[j];
+			i = j;
+		}
 	}
-	return true;
+
+	table[i].key = NULL;
+	table[i].value = NULL;
+	table[i].used = false;
+	htable->count--;
 }
 
 extern hashTable *hashTableNew    (unsigned int size,
@@ -137,8 +165,11 @@ extern hashTable *hashTableNew    (unsigned int size,
 	hashTable *htable;
 
 	htable = xMalloc (1, hashTable);
-	htable->size = size;
-	htable->table = xCalloc (size, hentry*);
+	htable->size = HTABLE_MIN_SIZE;
+	while (htable->size < size)
+		htable->size *= 2;
+	htable->count = 0;
+	htable->table = xCalloc (htable->size, hentry);
 
 	htable->hashfn = hashfn;
 	htable->equalfn = equalfn;
@@ -173,39 +204,57 @@ extern void       hashTableClear (hashTable *htable)
 	if (!htable)
 		return;
 
-	for (i = 0; i < htable->size; i++)
+	if (htable->count > 0 && (htable->keyfreefn || htable->valfreefn))
 	{
-		hentry *entry;
-
-		entry = htable->table[i];
-		entry_reclaim (entry, htable->keyfreefn, htable->valfreefn);
-		htable->table[i] = NULL;
+		for (i = 0; i < htable->size; i++)
+		{
+			hentry *entry = htable->table + i;
+
+			if (!entry->used)
+				continue;
+			if (htable->keyfreefn)
+				htable->keyfreefn (entry->key);
+			if (htable->valfreefn)
+				htable->valfreefn (entry->value);
+		}
 	}
+
+	memset (htable->table, 0, htable->size * sizeof (hentry));
+	htable->count = 0;
 }
 
 extern void       hashTablePutItem    (hashTable *htable, void *key, void *value)
 {
-	unsigned int i;
+	/* Keep the load factor 1/2 at most. */
+	if ((htable->count + 1) * 2 > htable->size)
+		table_grow (htable);
 
-	i = htable->hashfn (key) % htable->size;
-	htable->table[i] = entry_new(key, value, htable->table[i]);
+	entry_insert (htable->table, htable->size, key, value, key_hash (htable, key));
+	htable->count++;
 }
 
 extern void*      hashTableGetItem   (hashTable *htable, const void * key)
 {
-	unsigned int i;
+	long i = entry_find (htable, key, key_hash (htable, key));
 
-	i = htable->hashfn (key) % htable->size;
-	return entry_find(htable->table[i], key, htable->equalfn);
+	return (i < 0)? NULL: htable->table[i].value;
 }
 
 extern bool     hashTableDeleteItem (hashTable *htable, const void *key)
 {
-	unsigned int i;
+	long i = entry_find (htable, key, key_hash (htable, key));
+	hentry *entry;
 
-	i = htable->hashfn (key) % htable->size;
-	return entry_delete(&htable->table[i], key,
-			    htable->equalfn, htable->keyfreefn, htable->valfreefn);
+	if (i < 0)
+		return false;
+
+	entry = htable->table + i;
+	if (htable->keyfreefn)
+		htable->keyfreefn (entry->key);
+	if (htable->valfreefn)
+		htable->valfreefn (entry->value);
+	entry_remove (htable, (unsigned int)i);
+	return true;
 }
 
 extern bool    hashTableHasItem    (hashTable *htable, const void *key)
@@ -218,18 +267,9 @@ extern bool       hashTableForeachItem (hashTable *htable, hashTableForeachFunc
 	unsigned int i;
 
 	for (i = 0; i < htable->size; i++)
-		if (!entry_foreach(htable->table[i], proc, user_data))
-			return false;
-	return true;
-}
-
-static bool track_chain (const void *const key, void *value, void *chain_data)
-{
-	struct chainTracker *chain_tracker = chain_data;
-
-	if (chain_tracker->equalfn (chain_tracker->target_key, key))
 	{
-		if (! chain_tracker->user_proc (key, value, chain_tracker->user_data))
+		hentry *entry = htable->table + i;
+		if (entry->used && !proc (entry->key, entry->value, user_data))
 			return false;
 	}
 	return true;
@@ -237,32 +277,28 @@ static bool track_chain (const void *const key, void *value, void *chain_data)
 
 extern bool       hashTableForeachItemOnChain (hashTable *htable, const void *key, hashTableForeachFunc proc, void *user_data)
 {
-	unsigned int i;
-	struct chainTracker chain_tracker = {
-		.target_key = key,
-		.user_proc = proc,
-		.user_data = user_data,
-		.equalfn   = htable->equalfn,
-	};
-
-	i = htable->hashfn (key) % htable->size;
-	if (!entry_foreach(htable->table[i], track_chain, &chain_tracker))
-		return false;
-	return true;
-}
+	const unsigned int mask = htable->size - 1;
+	const unsigned int hash = key_hash (htable, key);
+	const unsigned int home = hash & mask;
+	unsigned int n = 0;
 
-static bool count (const void *const key CTAGS_ATTR_UNUSED, void *value CTAGS_ATTR_UNUSED, void *data)
-{
-	int *c = data;
-	++*c;
+	while (htable->table[(home + n) & mask].used)
+		n++;
+
+	/* Visit the items from the first occurrence; the last one put. */
+	while (n-- > 0)
+	{
+		hentry *entry = htable->table + ((home + n) & mask);
+		if (entry->hash == hash && htable->equalfn (key, entry->key)
+			&& !proc (entry->key, entry->value, user_data))
+			return false;
+	}
 	return true;
 }
 
 extern int        hashTableCountItem   (hashTable *htable)
 {
-	int c = 0;
-	hashTableForeachItem (htable, count, &c);
-	return c;
+	return (int)htable->count;
 }
 
 unsigned int hashPtrhash (const void * const x)
@@ -0,0 +1,498 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for updating a tag file incrementally
+*   (--incremental).
+*
+*   The modification time, the size, and a hash of the contents of each
+*   input file are recorded in the stamps file next to the tag file,
+*   together with a hash of the options. The names in the stamps file are
+*   escaped like the names in the tag file. An input file is parsed again
+*   only if its stamp doesn't match. If the options don't match, the tag
+*   file is made from scratch. The tags made from the old contents of
+*   re-parsed input files, and the tags of input files that no longer
+*   exist, are stale; they are dropped from the tag file.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "debug.h"
+#include "entry_p.h"
+#include "htable.h"
+#include "incremental_p.h"
+#include "mio.h"
+#include "options_p.h"
+#include "ptrarray.h"
+#include "read.h"
+#include "read_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "vstring.h"
+#include "writer_p.h"
+
+/*
+*   MACROS
+*/
+#define STAMPS_SUFFIX ".stamps"
+#define STAMPS_TIME_LINE "!_STAMPS_TIME"
+#define STAMPS_OPTIONS_LINE "!_STAMPS_OPTIONS"
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sInputStamp {
+	char *fileName;		/* the name of the input file given to ctags */
+	char *tagPath;		/* the name of the input file as written in the tag file */
+	time_t mtime;
+	unsigned long size;
+	unsigned long long hash;
+	bool visited;		/* the input file is found in this run */
+} inputStamp;
+
+/*
+*   DATA DEFINITIONS
+*/
+static hashTable *InputStamps;		/* tagPath -> inputStamp */
+static hashTable *StaleTagPaths;	/* tagPath -> tagPath */
+static time_t StampsTime;			/* when the loaded stamps were made */
+static time_t RunTime;				/* when the stamps of this run are made */
+static vString *LineTagPath;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void deleteInputStamp (void *data)
+{
+	inputStamp *stamp = data;
+
+	eFree (stamp->fileName);
+	if (stamp->tagPath)
+		eFree (stamp->tagPath);
+	eFree (stamp);
+}
+
+static char *makeStampsFileName (const char *const tagFileName)
+{
+	vString *name = vStringNewInit (tagFileName);
+
+	vStringCatS (name, STAMPS_SUFFIX);
+	return vStringDeleteUnwrap (name);
+}
+
+static unsigned long long hashInputMio (MIO *const mio)
+{
+	unsigned long long hash = FNV_OFFSET_BASIS;
+	unsigned char buffer [BUFSIZ];
+	unsigned char *data;
+	size_t n;
+
+	data = mio_memory_get_data (mio, &n);
+	if (data)
+		return hashBytes (hash, data, n);
+
+	while ((n = mio_read (mio, buffer, 1, sizeof (buffer))) > 0)
+		hash = hashBytes (hash, buffer, n);
+	mio_rewind (mio);
+	return hash;
+}
+
+static int xdigitValue (int digit)
+{
+	if ('0' <= digit && digit <= '9')
+		return digit - '0';
+	else if ('a' <= digit && digit <= 'f')
+		return 10 + digit - 'a';
+	else
+		return 10 + digit - 'A';
+}
+
+/* Undo vStringCatSWithEscaping () in place. */
+static void unescapeStampField (char *field)
+{
+	char *out = field;
+
+	for (const char *p = field; *p; p++)
+	{
+		int c = *p;
+
+		if (c == '\\')
+		{
+			switch (p [1])
+			{
+				case 'a': c = '\a'; p++; break;
+				case 'b': c = '\b'; p++; break;
+				case 't': c = '\t'; p++; break;
+				case 'n': c = '\n'; p++; break;
+				case 'v': c = '\v'; p++; break;
+				case 'f': c = '\f'; p++; break;
+				case 'r': c = '\r'; p++; break;
+				case '\\': c = '\\'; p++; break;
+				case 'x':
+					if (isxdigit ((unsigned char) p [2]) && isxdigit ((unsigned char) p [3]))
+					{
+						c = (xdigitValue (p [2]) << 4) | xdigitValue (p [3]);
+						p += 3;
+					}
+					break;
+			}
+		}
+		*out++ = c;
+	}
+	*out = '\0';
+}
+
+static char *makeStampTagPath (const char *const fileName)
+{
+	vString *tagPath = makeInputFileTagPath (fileName);
+	vString *escaped;
+
+	if (! writerDoesEscapeInputFileName ())
+		return vStringDeleteUnwrap (tagPath);
+
+	escaped = vStringNew ();
+	vStringCatSWithEscaping (escaped, vStringValue (tagPath));
+	vStringDelete (tagPath);
+	return vStringDeleteUnwrap (escaped);
+}
+
+static void initInputStamps (void)
+{
+	if (InputStamps)
+		return;
+
+	InputStamps = hashTableNew (1021, hashCstrhash, hashCstreq,
+								eFree, deleteInputStamp);
+	StaleTagPaths = hashTableNew (61, hashCstrhash, hashCstreq,
+								  eFree, NULL);
+	RunTime = time (NULL);
+}
+
+static bool parseStampLine (char *line)
+{
+	char *fields [5];
+	long long mtime;
+	unsigned long size;
+	unsigned long long hash;
+
+	fields [0] = line;
+	for (int i = 1; i < 5; i++)
+	{
+		fields [i] = strchr (fields [i - 1], '\t');
+		if (fields [i] == NULL)
+			return false;
+		*fields [i]++ = '\0';
+	}
+
+	unescapeStampField (fields [0]);
+	unescapeStampField (fields [1]);
+	if (sscanf (fields [2], "%lld", &mtime) != 1
+		|| sscanf (fields [3], "%lu", &size) != 1
+		|| sscanf (fields [4], "%llx", &hash) != 1)
+		return false;
+
+	inputStamp *stamp = xMalloc (1, inputStamp);
+	stamp->fileName = eStrdup (fields [0]);
+	stamp->tagPath = eStrdup (fields [1]);
+	stamp->mtime = (time_t) mtime;
+	stamp->size = size;
+	stamp->hash = hash;
+	stamp->visited = false;
+	hashTablePutItem (InputStamps, eStrdup (fields [1]), stamp);
+	return true;
+}
+
+/* Parse the header of the stamps file. Return false if the stamps were
+ * made with other options than this run. */
+static bool parseStampsHeader (MIO *mio, vString *vLine, const char *const stampsFileName)
+{
+	const char *line;
+	long long t;
+	unsigned long long hash;
+
+	line = readLineRaw (vLine, mio);
+	if (line == NULL)
+		return false;
+	vStringStripTrailing (vLine);
+	line = vStringValue (vLine);
+	if (strncmp (line, STAMPS_TIME_LINE "\t", strlen (STAMPS_TIME_LINE "\t")) != 0
+		|| sscanf (line + strlen (STAMPS_TIME_LINE "\t"), "%lld", &t) != 1)
+		return false;
+
+	line = readLineRaw (vLine, mio);
+	if (line == NULL)
+		return false;
+	vStringStripTrailing (vLine);
+	line = vStringValue (vLine);
+	if (strncmp (line, STAMPS_OPTIONS_LINE "\t", strlen (STAMPS_OPTIONS_LINE "\t")) != 0
+		|| sscanf (line + strlen (STAMPS_OPTIONS_LINE "\t"), "%llx", &hash) != 1
+		|| hash != getOptionsHash ())
+	{
+		verbose ("options differ from the ones recorded in \"%s\"; remaking the tag file\n",
+				 stampsFileName);
+		return false;
+	}
+
+	StampsTime = (time_t) t;
+	return true;
+}
+
+/* Load the stamps recorded when the tag file was made.
+ * Return false if there are no stamps to rely on. */
+extern bool loadInputStamps (const char *const tagFileName)
+{
+	char *stampsFileName = makeStampsFileName (tagFileName);
+	MIO *mio = mio_new_file (stampsFileName, "r");
+	vString *vLine;
+	char *line;
+	bool loaded;
+
+	initInputStamps ();
+	if (mio == NULL)
+	{
+		verbose ("no stamps file \"%s\"; remaking the tag file\n", stampsFileName);
+		eFree (stampsFileName);
+		return false;
+	}
+
+	vLine = vStringNew ();
+	loaded = parseStampsHeader (mio, vLine, stampsFileName);
+	while (loaded && (line = readLineRaw (vLine, mio)) != NULL)
+	{
+		vStringStripTrailing (vLine);
+		line = vStringValue (vLine);
+		if (! parseStampLine (line))
+		{
+			error (WARNING, "broken line in the stamps file \"%s\"; remaking the tag file",
+				   stampsFileName);
+			hashTableClear (InputStamps);
+			loaded = false;
+		}
+	}
+	vStringDelete (vLine);
+	mio_unref (mio);
+	eFree (stampsFileName);
+	return loaded;
+}
+
+static void markTagPathStale (char *tagPath)
+{
+	if (hashTableHasItem (StaleTagPaths, tagPath))
+		eFree (tagPath);
+	else
+		hashTablePutItem (StaleTagPaths, tagPath, tagPath);
+}
+
+/* Return true if FILENAME doesn't have to be parsed again. The stamp of
+ * FILENAME is looked up with the name written in the tag file, so that
+ * ctags can run in another directory than the last run if the names are
+ * relative to the tag file. Otherwise, the tags made from FILENAME at the last run become stale.
+ * If the contents of FILENAME are read to compare them, *MIO is set to
+ * the stream read; it can be passed to parseFileWithMio () not to read
+ * the file again. The caller unrefs it. */
+extern bool isInputFileUnchanged (const char *const fileName, const fileStatus *const status,
+								  MIO **mio)
+{
+	inputStamp *stamp;
+	char *tagPath;
+	unsigned long long hash = 0;
+
+	*mio = NULL;
+	if (! Option.incremental)
+		return false;
+
+	initInputStamps ();
+	tagPath = makeStampTagPath (fileName);
+	stamp = hashTableGetItem (InputStamps, tagPath);
+
+	/* The file may be modified in the same second as the last run made
+	 * the stamp. Trust the modification time only if it is older. */
+	if (stamp
+		&& stamp->mtime == status->mtime
+		&& stamp->size == status->size
+		&& stamp->mtime < StampsTime)
+	{
+		eFree (tagPath);
+		stamp->visited = true;
+		return true;
+	}
+
+	*mio = getMio (fileName, "rb", false);
+	if (*mio)
+		hash = hashInputMio (*mio);
+	if (stamp && stamp->size == status->size && stamp->hash == hash)
+	{
+		if (*mio)
+		{
+			mio_unref (*mio);
+			*mio = NULL;
+		}
+		eFree (tagPath);
+		stamp->mtime = status->mtime;
+		stamp->visited = true;
+		return true;
+	}
+
+	if (stamp)
+	{
+		markTagPathStale (stamp->tagPath);
+		eFree (stamp->fileName);
+	}
+	else
+	{
+		stamp = xMalloc (1, inputStamp);
+		hashTablePutItem (InputStamps, eStrdup (tagPath), stamp);
+	}
+	stamp->fileName = eStrdup (fileName);
+	stamp->tagPath = tagPath;
+	stamp->mtime = status->mtime;
+	stamp->size = status->size;
+	stamp->hash = hash;
+	stamp->visited = true;
+	return false;
+}
+
+/* Return the name of the input file of STAMP to look for it. The names
+ * made relative to the tag file are resolved against the directory of
+ * the tag file as the names in the tag file are, not against the current
+ * directory. */
+static char *makeStampInputFilePath (const inputStamp *const stamp)
+{
+	char *tagPath = eStrdup (stamp->tagPath);
+	char *path;
+
+	if (writerDoesEscapeInputFileName ())
+		unescapeStampField (tagPath);
+	if (isAbsolutePath (tagPath))
+		return tagPath;
+	else if (Option.tagRelative == TREL_NO)
+	{
+		eFree (tagPath);
+		return eStrdup (stamp->fileName);
+	}
+
+	path = combinePathAndFile (getTagFileDirectory (), tagPath);
+	eFree (tagPath);
+	return path;
+}
+
+static bool collectRemovedInput (const void *key, void *value, void *user_data)
+{
+	inputStamp *stamp = value;
+	ptrArray *removed = user_data;
+	char *path;
+
+	if (stamp->visited)
+		return true;
+
+	path = makeStampInputFilePath (stamp);
+	if (! doesFileExist (path))
+		ptrArrayAdd (removed, (void *) key);
+	eFree (path);
+	return true;
+}
+
+/* Drop the stamps of the input files that no longer exist.
+ * Their tags become stale. */
+extern void pruneInputStamps (void)
+{
+	ptrArray *removed;
+
+	if (InputStamps == NULL)
+		return;
+
+	removed = ptrArrayNew (NULL);
+	hashTableForeachItem (InputStamps, collectRemovedInput, removed);
+	for (unsigned int i = 0; i < ptrArrayCount (removed); i++)
+	{
+		const char *tagPath = ptrArrayItem (removed, i);
+		inputStamp *stamp = hashTableGetItem (InputStamps, tagPath);
+
+		verbose ("dropping tags of \"%s\" (removed)\n", stamp->fileName);
+		markTagPathStale (stamp->tagPath);
+		stamp->tagPath = NULL;
+		hashTableDeleteItem (InputStamps, tagPath);
+	}
+	ptrArrayDelete (removed);
+}
+
+/* Return true if LINE, a line of the tag file made at the last run,
+ * is for an input file parsed again or removed in this run. */
+extern bool isTagLineStale (const char *const line)
+{
+	const char *start, *end;
+
+	if (StaleTagPaths == NULL || hashTableCountItem (StaleTagPaths) == 0)
+		return false;
+	if (line [0] == '!' && line [1] == '_')
+		return false;
+
+	start = strchr (line, '\t');
+	if (start == NULL)
+		return false;
+	start++;
+	end = strchr (start, '\t');
+	if (end == NULL)
+		return false;
+
+	if (LineTagPath == NULL)
+		LineTagPath = vStringNew ();
+	vStringNCopyS (LineTagPath, start, end - start);
+	return hashTableHasItem (StaleTagPaths, vStringValue (LineTagPath));
+}
+
+static bool writeInputStamp (const void *key CTAGS_ATTR_UNUSED, void *value, void *user_data)
+{
+	inputStamp *stamp = value;
+	MIO *mio = user_data;
+	static vString *line;
+
+	line = vStringNewOrClearWithAutoRelease (line);
+	vStringCatSWithEscaping (line, stamp->fileName);
+	vStringPut (line, '\t');
+	vStringCatSWithEscaping (line, stamp->tagPath);
+	mio_printf (mio, "%s\t%lld\t%lu\t%016llx\n", vStringValue (line),
+				(long long) stamp->mtime, stamp->size, stamp->hash);
+	return true;
+}
+
+extern void saveInputStamps (const char *const tagFileName)
+{
+	char *stampsFileName;
+	MIO *mio;
+
+	if (InputStamps == NULL)
+		return;
+
+	stampsFileName = makeStampsFileName (tagFileName);
+	mio = mio_new_file (stampsFileName, "w");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open stamps file \"%s\"", stampsFileName);
+
+	mio_printf (mio, "%s\t%lld\n", STAMPS_TIME_LINE, (long long) RunTime);
+	mio_printf (mio, "%s\t%016llx\n", STAMPS_OPTIONS_LINE, getOptionsHash ());
+	hashTableForeachItem (InputStamps, writeInputStamp, mio);
+	if (mio_unref (mio) != 0)
+		error (FATAL | PERROR, "cannot write stamps file \"%s\"", stampsFileName);
+	eFree (stampsFileName);
+
+	hashTableDelete (InputStamps);
+	InputStamps = NULL;
+	hashTableDelete (StaleTagPaths);
+	StaleTagPaths = NULL;
+	if (LineTagPath)
+	{
+		vStringDelete (LineTagPath);
+		LineTagPath = NULL;
+	}
+}
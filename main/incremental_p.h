@@ -0,0 +1,30 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to incremental.c
+*/
+#ifndef CTAGS_MAIN_INCREMENTAL_PRIVATE_H
+#define CTAGS_MAIN_INCREMENTAL_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "mio.h"
+#include "routines_p.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern bool loadInputStamps (const char *const tagFileName);
+extern bool isInputFileUnchanged (const char *const fileName, const fileStatus *const status,
+								  MIO **mio);
+extern void pruneInputStamps (void);
+extern bool isTagLineStale (const char *const line);
+extern void saveInputStamps (const char *const tagFileName);
+
+#endif  /* CTAGS_MAIN_INCREMENTAL_PRIVATE_H */
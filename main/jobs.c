@@ -0,0 +1,494 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for parsing input files with worker
+*   processes (--jobs=N).
+*
+*   The main process collects the names of input files to parse in a
+*   queue. When the queue is run, or when it gets full while recursing
+*   into directories, the queued files are made a batch. The main process
+*   forks the workers for the batch and hands them the indexes of the
+*   files through a pipe. While the workers parse a batch started by a
+*   full queue, the main process goes on looking for the files of the
+*   next batch. A worker writes the tags
+*   of each file it parses to its own temporary data file, and records
+*   where the tags of the file begin and end in its own temporary index
+*   file. After all workers of a batch exit, the main process copies the
+*   tags to the tag file in the order the files were queued. A batch is
+*   not started before the one preceding it is merged. Thus the tag file is the
+*   same as the one made without workers.
+*
+*   The parser specific pseudo tags are written by the main process, at
+*   the positions the workers would have written them, because only the
+*   main process knows which parsers were used for the first time.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#if defined (HAVE_UNISTD_H)
+# include <unistd.h>
+#endif
+#if defined (HAVE_SYS_WAIT_H)
+# include <sys/wait.h>
+#endif
+
+#include "debug.h"
+#include "entry_p.h"
+#include "jobs_p.h"
+#include "mio.h"
+#include "numarray.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "stats_p.h"
+#include "strlist.h"
+
+#if defined (HAVE_FORK) && defined (HAVE_PIPE) && defined (HAVE_WAITPID) && defined (HAVE_SYS_WAIT_H)
+# define JOBS_SUPPORTED
+#endif
+
+/*
+*   DATA DECLARATIONS
+*/
+#ifdef JOBS_SUPPORTED
+typedef struct sJobWorker {
+	pid_t pid;
+	MIO *data;
+	char *dataName;
+	MIO *index;
+	char *indexName;
+} jobWorker;
+
+/* A record written to the index file of a worker for each parsed file.
+ * COUNT pairs of a language and an offset in the data file follow
+ * the record. They tell where parser specific pseudo tags are expected. */
+typedef struct sJobRecord {
+	unsigned int file;
+	long start;
+	long end;
+	unsigned long numTags;
+	unsigned int count;
+} jobRecord;
+
+/* The record terminating the index file. The numbers of files, lines,
+ * and bytes scanned by the worker are put in start, end, and numTags. */
+#define JOB_RECORD_TOTALS ((unsigned int) -1)
+
+typedef struct sJobResult {
+	unsigned int worker;
+	jobRecord record;
+	intArray *languages;
+	longArray *offsets;
+} jobResult;
+
+typedef struct sJobBatch {
+	stringList *files;
+	jobWorker *workers;
+	unsigned int nworkers;
+	bool failed;
+} jobBatch;
+
+/* The number of files queued for each worker before a batch is started
+ * without waiting for runJobs(). */
+#define JOB_BATCH_FILES_PER_WORKER 256
+
+/* The indexes of the files of such a batch must fit in a pipe buffer, so
+ * that the main process can go on looking for files without waiting for
+ * the workers to read them. 16 KiB is the smallest pipe buffer among the
+ * platforms supporting --jobs. */
+#define JOB_BATCH_FILES_MAX (16384 / sizeof (unsigned int))
+#endif
+
+/*
+*   DATA DEFINITIONS
+*/
+static stringList *JobQueue;
+#ifdef JOBS_SUPPORTED
+static jobBatch *RunningBatch;
+#endif
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern bool useJobs (void)
+{
+#ifdef JOBS_SUPPORTED
+	return (bool) (Option.jobs > 1
+				   && ! Option.filter
+				   && ! Option.printLanguage
+				   && ! Option.interactive);
+#else
+	return false;
+#endif
+}
+
+#ifdef JOBS_SUPPORTED
+static jobBatch *startJobBatch (stringList *files);
+static void finishJobBatch (jobBatch *batch);
+
+static unsigned int getJobBatchSize (void)
+{
+	const unsigned int size = Option.jobs * JOB_BATCH_FILES_PER_WORKER;
+	return size < JOB_BATCH_FILES_MAX? size: JOB_BATCH_FILES_MAX;
+}
+#endif
+
+extern void queueJob (const char *const fileName)
+{
+	if (JobQueue == NULL)
+		JobQueue = stringListNew ();
+	stringListAdd (JobQueue, vStringNewInit (fileName));
+
+#ifdef JOBS_SUPPORTED
+	/* Let the workers parse the files found so far while the caller
+	 * looks for more. */
+	if (stringListCount (JobQueue) >= getJobBatchSize ())
+	{
+		if (RunningBatch)
+			finishJobBatch (RunningBatch);
+		RunningBatch = startJobBatch (JobQueue);
+		JobQueue = NULL;
+	}
+#endif
+}
+
+#ifdef JOBS_SUPPORTED
+
+static void writeIndex (MIO *index, const void *ptr, size_t size)
+{
+	if (mio_write (index, ptr, size, 1) != 1)
+		error (FATAL | PERROR, "cannot write to job index file");
+}
+
+static void readIndex (MIO *index, void *ptr, size_t size)
+{
+	if (mio_read (index, ptr, size, 1) != 1)
+		error (FATAL | PERROR, "cannot read from job index file");
+}
+
+struct deferredPseudoTags {
+	intArray *languages;
+	longArray *offsets;
+};
+
+static void deferPseudoTags (langType language, void *data)
+{
+	struct deferredPseudoTags *deferred = data;
+
+	intArrayAdd (deferred->languages, language);
+	longArrayAdd (deferred->offsets, tagFileOffset ());
+}
+
+static bool readTask (int fd, unsigned int *file)
+{
+	ssize_t r;
+
+	do
+		r = read (fd, file, sizeof (*file));
+	while (r < 0 && errno == EINTR);
+
+	if (r < 0)
+		error (FATAL | PERROR, "cannot read from job queue");
+	return (bool) (r == sizeof (*file));
+}
+
+static void runWorker (jobWorker *worker, const stringList *fileNames, int fd)
+{
+	struct deferredPseudoTags deferred = {
+		.languages = intArrayNew (),
+		.offsets = longArrayNew (),
+	};
+	long files0, lines0, bytes0;
+	long files, lines, bytes;
+	unsigned int file;
+
+	redirectTagFile (worker->data);
+	deferParserPseudoTags (deferPseudoTags, &deferred);
+	getTotals (&files0, &lines0, &bytes0);
+
+	while (readTask (fd, &file))
+	{
+		jobRecord record = {
+			.file = file,
+			.start = mio_tell (worker->data),
+			.numTags = numTagsAdded (),
+		};
+
+		intArrayClear (deferred.languages);
+		longArrayClear (deferred.offsets);
+		parseFile (vStringValue (stringListItem (fileNames, file)));
+
+		record.end = mio_tell (worker->data);
+		record.numTags = numTagsAdded () - record.numTags;
+		record.count = intArrayCount (deferred.languages);
+
+		writeIndex (worker->index, &record, sizeof (record));
+		for (unsigned int i = 0; i < record.count; i++)
+		{
+			int language = intArrayItem (deferred.languages, i);
+			long offset = longArrayItem (deferred.offsets, i);
+			writeIndex (worker->index, &language, sizeof (language));
+			writeIndex (worker->index, &offset, sizeof (offset));
+		}
+	}
+
+	getTotals (&files, &lines, &bytes);
+	jobRecord totals = {
+		.file = JOB_RECORD_TOTALS,
+		.start = files - files0,
+		.end = lines - lines0,
+		.numTags = bytes - bytes0,
+	};
+	writeIndex (worker->index, &totals, sizeof (totals));
+
+	if (mio_flush (worker->data) != 0 || mio_flush (worker->index) != 0)
+		error (FATAL | PERROR, "cannot flush job output");
+
+	/* Leave the streams inherited from the main process alone. */
+	_exit (0);
+}
+
+static void readWorkerIndex (jobWorker *worker, unsigned int w,
+							 jobResult *results, unsigned int count)
+{
+	jobRecord record;
+
+	mio_rewind (worker->index);
+	while (readIndex (worker->index, &record, sizeof (record)),
+		   record.file != JOB_RECORD_TOTALS)
+	{
+		if (record.file >= count)
+			error (FATAL, "broken job index file: %s", worker->indexName);
+
+		jobResult *r = results + record.file;
+		r->worker = w;
+		r->record = record;
+		if (record.count > 0)
+		{
+			r->languages = intArrayNew ();
+			r->offsets = longArrayNew ();
+		}
+		for (unsigned int i = 0; i < record.count; i++)
+		{
+			int language;
+			long offset;
+			readIndex (worker->index, &language, sizeof (language));
+			readIndex (worker->index, &offset, sizeof (offset));
+			intArrayAdd (r->languages, language);
+			longArrayAdd (r->offsets, offset);
+		}
+	}
+	addTotals ((unsigned int) record.start,
+			   (unsigned long) record.end, record.numTags);
+}
+
+static void mergeResult (jobResult *r, jobWorker *workers)
+{
+	MIO *data = workers [r->worker].data;
+	long pos = r->record.start;
+
+	if (mio_seek (data, pos, SEEK_SET) != 0)
+		error (FATAL | PERROR, "cannot seek in job data file");
+
+	for (unsigned int i = 0; i < r->record.count; i++)
+	{
+		long offset = longArrayItem (r->offsets, i);
+		appendTagFileChunk (data, offset - pos, 0);
+		pos = offset;
+		makeDeferredParserPseudoTags (intArrayItem (r->languages, i));
+	}
+	appendTagFileChunk (data, r->record.end - pos, r->record.numTags);
+}
+
+static void deleteWorkerFiles (jobWorker *worker)
+{
+	if (worker->data)
+	{
+		mio_unref (worker->data);
+		remove (worker->dataName);
+		eFree (worker->dataName);
+	}
+	if (worker->index)
+	{
+		mio_unref (worker->index);
+		remove (worker->indexName);
+		eFree (worker->indexName);
+	}
+}
+
+/* Fork the workers parsing FILES, and return without waiting for them.
+ * The batch takes FILES over. */
+static jobBatch *startJobBatch (stringList *files)
+{
+	const unsigned int count = stringListCount (files);
+	const unsigned int nworkers = Option.jobs < count? Option.jobs: count;
+	jobBatch *batch = xCalloc (1, jobBatch);
+	jobWorker *workers = xCalloc (nworkers, jobWorker);
+	int fds [2];
+
+	verbose ("parsing %u files with %u workers\n", count, nworkers);
+
+	batch->files = files;
+	batch->workers = workers;
+	batch->nworkers = nworkers;
+
+	for (unsigned int w = 0; w < nworkers; w++)
+	{
+		workers [w].data = tempFile ("w+b", &workers [w].dataName);
+		workers [w].index = tempFile ("w+b", &workers [w].indexName);
+	}
+
+	if (pipe (fds) != 0)
+		error (FATAL | PERROR, "cannot make a pipe for job queue");
+
+	/* Nothing buffered may be inherited by the workers; a worker exiting
+	 * with error() would write it again. */
+	flushTagFile ();
+	fflush (stdout);
+	fflush (stderr);
+
+	for (unsigned int w = 0; w < nworkers; w++)
+	{
+		workers [w].pid = fork ();
+		if (workers [w].pid < 0)
+			error (FATAL | PERROR, "cannot fork a worker process");
+		else if (workers [w].pid == 0)
+		{
+			close (fds [1]);
+			runWorker (workers + w, files, fds [0]);
+		}
+	}
+	close (fds [0]);
+
+	/* The indexes of a batch started by a full queue fit in a pipe buffer
+	 * (see JOB_BATCH_FILES_MAX), so this doesn't wait for the workers.
+	 * The last batch, run by runJobs (), may be larger; then this waits
+	 * for the workers to read the indexes. If they all died, write ()
+	 * fails with EPIPE instead of killing ctags with SIGPIPE. */
+#ifdef SIGPIPE
+	void (*sigpipeHandler) (int) = signal (SIGPIPE, SIG_IGN);
+#endif
+	for (unsigned int i = 0; i < count; i++)
+	{
+		ssize_t r;
+		do
+			r = write (fds [1], &i, sizeof (i));
+		while (r < 0 && errno == EINTR);
+
+		if (r != sizeof (i))
+		{
+			error (WARNING | PERROR, "cannot write to job queue");
+			batch->failed = true;
+			break;
+		}
+	}
+	close (fds [1]);
+#ifdef SIGPIPE
+	signal (SIGPIPE, sigpipeHandler);
+#endif
+
+	return batch;
+}
+
+/* Wait for the workers of BATCH, and merge their tags to the tag file. */
+static void finishJobBatch (jobBatch *batch)
+{
+	const unsigned int count = stringListCount (batch->files);
+	jobWorker *workers = batch->workers;
+	const unsigned int nworkers = batch->nworkers;
+	bool failed = batch->failed;
+
+	for (unsigned int w = 0; w < nworkers; w++)
+	{
+		int status;
+		while (waitpid (workers [w].pid, &status, 0) < 0)
+		{
+			if (errno != EINTR)
+				error (FATAL | PERROR, "cannot wait for a worker process");
+		}
+		if (! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		{
+			error (WARNING, "worker process %ld failed", (long) workers [w].pid);
+			failed = true;
+		}
+	}
+
+	if (! failed)
+	{
+		jobResult *results = xCalloc (count, jobResult);
+
+		for (unsigned int w = 0; w < nworkers; w++)
+			readWorkerIndex (workers + w, w, results, count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			mergeResult (results + i, workers);
+			if (results [i].languages)
+			{
+				intArrayDelete (results [i].languages);
+				longArrayDelete (results [i].offsets);
+			}
+		}
+		eFree (results);
+	}
+
+	for (unsigned int w = 0; w < nworkers; w++)
+		deleteWorkerFiles (workers + w);
+	eFree (workers);
+	stringListDelete (batch->files);
+	eFree (batch);
+
+	if (failed)
+		error (FATAL, "failed in parsing input files with worker processes");
+}
+#endif
+
+/* Parse the queued files. */
+extern void runJobs (void)
+{
+	unsigned int count = JobQueue? stringListCount (JobQueue): 0;
+
+#ifdef JOBS_SUPPORTED
+	if (RunningBatch)
+	{
+		finishJobBatch (RunningBatch);
+		RunningBatch = NULL;
+	}
+#endif
+
+	if (count == 0)
+		return;
+
+#ifdef JOBS_SUPPORTED
+	if (count > 1)
+	{
+		finishJobBatch (startJobBatch (JobQueue));
+		JobQueue = NULL;
+		return;
+	}
+#endif
+
+	for (unsigned int i = 0; i < count; i++)
+		parseFile (vStringValue (stringListItem (JobQueue, i)));
+
+	stringListClear (JobQueue);
+}
+
+extern void freeJobsResources (void)
+{
+	if (JobQueue)
+	{
+		stringListDelete (JobQueue);
+		JobQueue = NULL;
+	}
+}
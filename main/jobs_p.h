@@ -0,0 +1,25 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to jobs.c
+*/
+#ifndef CTAGS_MAIN_JOBS_PRIVATE_H
+#define CTAGS_MAIN_JOBS_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern bool useJobs (void);
+extern void queueJob (const char *const fileName);
+extern void runJobs (void);
+extern void freeJobsResources (void);
+
+#endif  /* CTAGS_MAIN_JOBS_PRIVATE_H */
@@ -25,52 +25,66 @@
 *   DATA DECLARATIONS
 */
 typedef struct sHashEntry {
-	struct sHashEntry *next;
-	const char *string;
-	langType language;
+	const char *string;		/* NULL if the entry is empty */
+	size_t length;
+	unsigned int hash;
 	int value;
 } hashEntry;
 
+/* Each language has its own table, using open addressing with linear
+ * probing. A lookup compares the hash and the length of the string before
+ * comparing the strings, and never walks into another language's keywords.
+ */
+typedef struct sKeywordHash {
+	hashEntry *entries;
+	unsigned int size;		/* a power of 2 */
+	unsigned int count;
+} keywordHash;
+
 /*
 *   DATA DEFINITIONS
 */
-static const unsigned int TableSize = 2039;  /* prime */
-static hashEntry **HashTable = NULL;
+static const unsigned int InitialTableSize = 64;
+static keywordHash **HashTables = NULL;
+static unsigned int HashTableCount = 0;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static hashEntry **getHashTable (void)
+static keywordHash *getHashTable (langType language, bool create)
 {
-	static bool allocated = false;
+	if (language < 0)
+		return NULL;
 
-	if (! allocated)
+	if ((unsigned int) language >= HashTableCount)
 	{
-		unsigned int i;
-
-		HashTable = xMalloc (TableSize, hashEntry*);
+		unsigned int count = HashTableCount? HashTableCount: 64;
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
-			HashTable [i] = NULL;
+		if (! create)
+			return NULL;
 
-		allocated = true;
+		while (count <= (unsigned int) language)
+			count *= 2;
+		HashTables = xRealloc (HashTables, count, keywordHash*);
+		memset (HashTables + HashTableCount, 0,
+				(count - HashTableCount) * sizeof (keywordHash*));
+		HashTableCount = count;
 	}
-	return HashTable;
-}
-
-static hashEntry *getHashTableEntry (unsigned long hashedValue)
-{
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry;
 
-	Assert (hashedValue < TableSize);
-	entry = table [hashedValue];
+	if (HashTables [language] == NULL && create)
+	{
+		keywordHash *table = xMalloc (1, keywordHash);
 
-	return entry;
+		table->entries = xCalloc (InitialTableSize, hashEntry);
+		table->size = InitialTableSize;
+		table->count = 0;
+		HashTables [language] = table;
+	}
+	return HashTables [language];
 }
 
-static unsigned int hashValue (const char *const string, langType language)
+static unsigned int hashValue (const char *const string, size_t *length)
 {
 	const signed char *p;
 	unsigned int h = 5381;
@@ -81,23 +95,55 @@ static unsigned int hashValue (const char *const string, langType language)
 	for (p = (const signed char *)string; *p != '\0'; p++)
 		h = (h << 5) + h + tolower (*p);
 
-	/* consider language as an extra "character" and add it to the hash */
-	h = (h << 5) + h + language;
-
+	*length = (const char *) p - string;
 	return h;
 }
 
-static hashEntry *newEntry (
-		const char *const string, langType language, int value)
+static void insertEntry (keywordHash *const table, const hashEntry *const entry)
 {
-	hashEntry *const entry = xMalloc (1, hashEntry);
+	const unsigned int mask = table->size - 1;
+	unsigned int i;
 
-	entry->next     = NULL;
-	entry->string   = string;
-	entry->language = language;
-	entry->value    = value;
+	for (i = entry->hash & mask; table->entries [i].string; i = (i + 1) & mask)
+		;
+	table->entries [i] = *entry;
+	table->count++;
+}
 
-	return entry;
+static void growHashTable (keywordHash *const table)
+{
+	hashEntry *const old = table->entries;
+	const unsigned int oldSize = table->size;
+	unsigned int i;
+
+	table->size *= 2;
+	table->entries = xCalloc (table->size, hashEntry);
+	table->count = 0;
+	for (i = 0  ;  i < oldSize  ;  ++i)
+		if (old [i].string)
+			insertEntry (table, old + i);
+	eFree (old);
+}
+
+static hashEntry *findEntry (const keywordHash *const table,
+							 const char *const string, bool caseSensitive)
+{
+	const unsigned int mask = table->size - 1;
+	size_t length;
+	const unsigned int hash = hashValue (string, &length);
+	unsigned int i;
+
+	for (i = hash & mask; table->entries [i].string; i = (i + 1) & mask)
+	{
+		hashEntry *const entry = table->entries + i;
+
+		if (entry->hash == hash && entry->length == length
+			&& (caseSensitive
+				? memcmp (string, entry->string, length) == 0
+				: strncasecmp (string, entry->string, length) == 0))
+			return entry;
+	}
+	return NULL;
 }
 
 /*  Note that it is assumed that a "value" of zero means an undefined keyword
@@ -107,54 +153,35 @@ static hashEntry *newEntry (
  */
 extern void addKeyword (const char *const string, langType language, int value)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
+	keywordHash *const table = getHashTable (language, true);
+	hashEntry entry;
 
-	if (entry == NULL)
+	Assert (table != NULL);
+	if (findEntry (table, string, true) != NULL)
 	{
-		hashEntry **const table = getHashTable ();
-		table [index] = newEntry (string, language, value);
+		Assert (("Already in table" == NULL));
 	}
-	else
-	{
-		hashEntry *prev = NULL;
 
-		while (entry != NULL)
-		{
-			if (language == entry->language  &&
-				strcmp (string, entry->string) == 0)
-			{
-				Assert (("Already in table" == NULL));
-			}
-			prev = entry;
-			entry = entry->next;
-		}
-		if (entry == NULL)
-		{
-			Assert (prev != NULL);
-			prev->next = newEntry (string, language, value);
-		}
-	}
+	/* Keep the load factor 1/2 at most. */
+	if (2 * (table->count + 1) > table->size)
+		growHashTable (table);
+
+	entry.string = string;
+	entry.hash   = hashValue (string, &entry.length);
+	entry.value  = value;
+	insertEntry (table, &entry);
 }
 
 static int lookupKeywordFull (const char *const string, bool caseSensitive, langType language)
 {
-	const unsigned int index = hashValue (string, language) % TableSize;
-	hashEntry *entry = getHashTableEntry (index);
-	int result = KEYWORD_NONE;
+	const keywordHash *const table = getHashTable (language, false);
+	const hashEntry *entry;
 
-	while (entry != NULL)
-	{
-		if (language == entry->language &&
-			((caseSensitive && strcmp (string, entry->string) == 0) ||
-			 (!caseSensitive && strcasecmp (string, entry->string) == 0)))
-		{
-			result = entry->value;
-			break;
-		}
-		entry = entry->next;
-	}
-	return result;
+	if (table == NULL)
+		return KEYWORD_NONE;
+
+	entry = findEntry (table, string, caseSensitive);
+	return entry? entry->value: KEYWORD_NONE;
 }
 
 extern int lookupKeyword (const char *const string, langType language)
@@ -169,91 +196,74 @@ extern int lookupCaseKeyword (const char *const string, langType language)
 
 extern void freeKeywordTable (void)
 {
-	if (HashTable != NULL)
+	if (HashTables != NULL)
 	{
 		unsigned int i;
 
-		for (i = 0  ;  i < TableSize  ;  ++i)
+		for (i = 0  ;  i < HashTableCount  ;  ++i)
 		{
-			hashEntry *entry = HashTable [i];
-
-			while (entry != NULL)
-			{
-				hashEntry *next = entry->next;
-				eFree (entry);
-				entry = next;
-			}
+			if (HashTables [i] == NULL)
+				continue;
+			eFree (HashTables [i]->entries);
+			eFree (HashTables [i]);
 		}
-		eFree (HashTable);
+		eFree (HashTables);
+		HashTables = NULL;
+		HashTableCount = 0;
 	}
 }
 
 #ifdef DEBUG
 
-static void printEntry (const hashEntry *const entry)
+static unsigned int printHashTable (const keywordHash *const table, langType language)
 {
-	printf ("  %-15s %-7s\n", entry->string, getLanguageName (entry->language));
-}
+	const unsigned int mask = table->size - 1;
+	unsigned int measure = 0;
+	unsigned int i;
 
-static unsigned int printBucket (const unsigned int i)
-{
-	hashEntry **const table = getHashTable ();
-	hashEntry *entry = table [i];
-	unsigned int measure = 1;
-	bool first = true;
-
-	printf ("%2d:", i);
-	if (entry == NULL)
-		printf ("\n");
-	else while (entry != NULL)
+	printf ("%s: %u keywords in %u entries\n", getLanguageName (language),
+			table->count, table->size);
+	for (i = 0  ;  i < table->size  ;  ++i)
 	{
-		if (! first)
-			printf ("    ");
-		else
-		{
-			printf (" ");
-			first = false;
-		}
-		printEntry (entry);
-		entry = entry->next;
-		measure = 2 * measure;
+		const hashEntry *const entry = table->entries + i;
+		unsigned int distance;
+
+		if (entry->string == NULL)
+			continue;
+		distance = (i - entry->hash) & mask;
+		printf ("%4u: %-15s +%u\n", i, entry->string, distance);
+		measure += distance;
 	}
-	return measure - 1;
+	return measure;
 }
 
 extern void printKeywordTable (void)
 {
-	unsigned long emptyBucketCount = 0;
 	unsigned long measure = 0;
 	unsigned int i;
 
-	for (i = 0  ;  i < TableSize  ;  ++i)
-	{
-		const unsigned int pass = printBucket (i);
-
-		measure += pass;
-		if (pass == 0)
-			++emptyBucketCount;
-	}
+	for (i = 0  ;  i < HashTableCount  ;  ++i)
+		if (HashTables [i])
+			measure += printHashTable (HashTables [i], i);
 
-	printf ("spread measure = %ld\n", measure);
-	printf ("%ld empty buckets\n", emptyBucketCount);
+	printf ("probe measure = %ld\n", measure);
 }
 
 #endif
 
 extern void dumpKeywordTable (FILE *fp)
 {
-	unsigned int i;
-	for (i = 0  ;  i < TableSize  ;  ++i)
+	unsigned int i, j;
+
+	for (i = 0  ;  i < HashTableCount  ;  ++i)
 	{
-		hashEntry **const table = getHashTable ();
-		hashEntry *entry = table [i];
-		while (entry != NULL)
-		{
-			fprintf(fp, "%s	%s\n", entry->string, getLanguageName (entry->language));
-			entry = entry->next;
-		}
+		const keywordHash *const table = HashTables [i];
+
+		if (table == NULL)
+			continue;
+		for (j = 0  ;  j < table->size  ;  ++j)
+			if (table->entries [j].string)
+				fprintf(fp, "%s	%s\n", table->entries [j].string, getLanguageName (i));
 	}
 }
 
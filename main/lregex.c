@@ -165,6 +165,24 @@ typedef struct {
 
 	char *pattern_string;
 
+	/* The text to match must begin with prefix.literal after the
+	 * characters in prefix.skip. regexec is not called for the text
+	 * not doing so. literal is NULL if the pattern has no such prefix. */
+	struct {
+		char *literal;
+		size_t length;
+		char *skip;
+		bool icase;
+	} prefix;
+
+	/* The text to match must contain required.literal. regexec is not
+	 * called for the text not containing it. literal is NULL if no such
+	 * literal is found in the pattern. */
+	struct {
+		char *literal;
+		size_t length;
+	} required;
+
 	char *anonymous_tag_prefix;
 
 	struct {
@@ -184,6 +202,7 @@ typedef struct {
 	struct {
 		unsigned int match;
 		unsigned int unmatch;
+		unsigned int skip;		/* unmatched without calling regexec */
 	} statistics;
 } regexTableEntry;
 
@@ -279,6 +298,13 @@ static void deletePattern (regexPattern *p)
 
 	eFree (p->pattern_string);
 
+	if (p->prefix.literal)
+		eFree (p->prefix.literal);
+	if (p->prefix.skip)
+		eFree (p->prefix.skip);
+	if (p->required.literal)
+		eFree (p->required.literal);
+
 	if (p->message.message_string)
 		eFree (p->message.message_string);
 
@@ -1303,21 +1329,26 @@ static flagDefinition regexFlagDefs[] = {
 	  NULL, "applied in a case-insensitive manner"},
 };
 
-static regex_t* compileRegex (enum regexParserType regptype,
-							  const char* const regexp, const char* const flags)
+static int getRegexCompileFlags (enum regexParserType regptype, const char* const flags)
 {
 	int cflags = REG_EXTENDED | REG_NEWLINE;
 
 	if (regptype == REG_PARSER_MULTI_TABLE)
 		cflags &= ~REG_NEWLINE;
 
-	regex_t *result;
-	int errcode;
-
 	flagsEval (flags,
 		   regexFlagDefs,
 		   ARRAY_SIZE(regexFlagDefs),
 		   &cflags);
+	return cflags;
+}
+
+static regex_t* compileRegex (enum regexParserType regptype,
+							  const char* const regexp, const char* const flags)
+{
+	int cflags = getRegexCompileFlags (regptype, flags);
+	regex_t *result;
+	int errcode;
 
 	result = xMalloc (1, regex_t);
 	errcode = regcomp (result, regexp, cflags);
@@ -1334,6 +1365,328 @@ static regex_t* compileRegex (enum regexParserType regptype,
 }
 
 
+/* Parse a bracket expression made only of characters and the [:space:]
+ * and [:blank:] classes, like "[ \t]". Return the position after it, or
+ * NULL if it is not such one. */
+static const char *parseSimpleBracket (const char *p, vString *set)
+{
+	Assert (*p == '[');
+
+	p++;
+	if (*p == '^' || *p == ']')
+		return NULL;
+	while (*p != ']')
+	{
+		if (*p == '\0')
+			return NULL;
+		else if (strncmp (p, "[:space:]", 9) == 0)
+		{
+			vStringCatS (set, " \t\n\v\f\r");
+			p += 9;
+		}
+		else if (strncmp (p, "[:blank:]", 9) == 0)
+		{
+			vStringCatS (set, " \t");
+			p += 9;
+		}
+		else if (*p == '[' || (p [1] == '-' && p [2] != ']'))
+			return NULL;	/* other classes or a range */
+		else
+			vStringPut (set, *p++);
+	}
+	return p + 1;
+}
+
+/* Parse a quantifier. Return the position after it, P if there is no
+ * quantifier, or NULL if it is broken. */
+static const char *parseQuantifier (const char *p, bool extended)
+{
+	if (*p == '*')
+		return p + 1;
+	if (!extended)
+		return (p [0] == '\\' && p [1] != '\0' && strchr ("{+?", p [1]))? NULL: p;
+	if (*p == '+' || *p == '?')
+		return p + 1;
+	if (*p == '{')
+	{
+		p++;
+		if (!isdigit ((unsigned char) *p))
+			return NULL;
+		while (isdigit ((unsigned char) *p) || *p == ',')
+			p++;
+		return (*p == '}')? p + 1: NULL;
+	}
+	return p;
+}
+
+static bool isInSkipSet (const char *skip, int c, bool icase)
+{
+	if (c == '\0')
+		return false;
+	if (strchr (skip, c))
+		return true;
+	return icase && (strchr (skip, tolower (c)) || strchr (skip, toupper (c)));
+}
+
+/* Find the literal text that the text matching an anchored pattern like
+ * "^[ \t]*def[ \t]+" must begin with, optionally after some blank
+ * characters. A pattern not understood here gets no prefix. */
+static void analyzeRegexPrefix (regexPattern *ptrn, const char *regex, const char *flags)
+{
+	int cflags;
+	bool extended;
+	const char *p;
+	vString *skip;
+	vString *literal;
+
+	if (ptrn->regptype == REG_PARSER_MULTI_LINE)
+		return;	/* "^" matches at the start of any line in the input */
+	if (regex [0] != '^' || strchr (regex, '|'))
+		return;
+
+	cflags = getRegexCompileFlags (ptrn->regptype, flags);
+	extended = (cflags & REG_EXTENDED);
+	skip = vStringNew ();
+	literal = vStringNew ();
+
+	p = regex + 1;
+	if (*p == '[' || *p == ' ')
+	{
+		if (*p == '[')
+			p = parseSimpleBracket (p, skip);
+		else
+			vStringPut (skip, *p++);
+		if (p)
+			p = parseQuantifier (p, extended);
+		if (p == NULL)
+			goto out;
+	}
+
+	while (*p != '\0')
+	{
+		int c = *p;
+
+		if (extended && c == '\\' && p [1] != '\0' && strchr (".[]\\()*+?{}|^$/", p [1]))
+			c = p [1];
+		else if (strchr (extended? ".[]\\()*+?{}|^$": ".[]\\*^$", c))
+			break;
+
+		const char *next = p + ((*p == '\\')? 2: 1);
+		const char *q = parseQuantifier (next, extended);
+		if (q == NULL || q != next)
+			break;	/* c may not appear */
+		vStringPut (literal, c);
+		p = next;
+	}
+
+	if (vStringLength (literal) > 0
+		&& !isInSkipSet (vStringValue (skip), vStringChar (literal, 0),
+						 (cflags & REG_ICASE)))
+	{
+		ptrn->prefix.length = vStringLength (literal);
+		ptrn->prefix.literal = vStringStrdup (literal);
+		ptrn->prefix.skip = vStringStrdup (skip);
+		ptrn->prefix.icase = (cflags & REG_ICASE);
+	}
+
+ out:
+	vStringDelete (literal);
+	vStringDelete (skip);
+}
+
+static bool mayMatchPrefix (const regexPattern *ptrn, const char *text)
+{
+	if (ptrn->prefix.literal == NULL)
+		return true;
+
+	while (isInSkipSet (ptrn->prefix.skip, (unsigned char) *text, ptrn->prefix.icase))
+		text++;
+	if (ptrn->prefix.icase)
+		return strnuppercmp (text, ptrn->prefix.literal, ptrn->prefix.length) == 0;
+	return strncmp (text, ptrn->prefix.literal, ptrn->prefix.length) == 0;
+}
+
+/* Skip a bracket expression. Return the position after it, or NULL
+ * if it is broken. */
+static const char *skipBracket (const char *p)
+{
+	Assert (*p == '[');
+
+	p++;
+	if (*p == '^')
+		p++;
+	if (*p == ']')
+		p++;
+	while (*p != ']')
+	{
+		if (*p == '\0')
+			return NULL;
+		else if (*p == '[' && p [1] != '\0' && strchr (":=.", p [1]))
+		{
+			const char close [3] = { p [1], ']', '\0' };
+			p = strstr (p + 2, close);
+			if (p == NULL)
+				return NULL;
+			p += 2;
+		}
+		else
+			p++;
+	}
+	return p + 1;
+}
+
+/* Skip a group whose opening parenthesis is just before P. Return the
+ * position after it, or NULL if it is broken. */
+static const char *skipGroup (const char *p, bool extended)
+{
+	int depth = 1;
+
+	while (*p != '\0')
+	{
+		if (*p == '[')
+		{
+			p = skipBracket (p);
+			if (p == NULL)
+				return NULL;
+		}
+		else if (*p == '\\')
+		{
+			if (p [1] == '\0')
+				return NULL;
+			if (!extended && p [1] == '(')
+				depth++;
+			else if (!extended && p [1] == ')' && --depth == 0)
+				return p + 2;
+			p += 2;
+		}
+		else if (extended && *p == '(')
+		{
+			depth++;
+			p++;
+		}
+		else if (extended && *p == ')' && --depth == 0)
+			return p + 1;
+		else
+			p++;
+	}
+	return NULL;
+}
+
+/* Find the longest literal text that the text matching a pattern like
+ * "[a-z]+ = function" must contain, wherever the match is. Groups and
+ * optional characters are not looked into. */
+static void analyzeRegexRequired (regexPattern *ptrn, const char *regex, const char *flags)
+{
+	int cflags;
+	bool extended;
+	const char *p;
+	vString *run;
+	vString *best;
+
+	if (ptrn->regptype == REG_PARSER_MULTI_TABLE)
+		return;	/* searching the rest of the input at each offset costs too much */
+	if (strchr (regex, '|'))
+		return;
+	cflags = getRegexCompileFlags (ptrn->regptype, flags);
+	if (cflags & REG_ICASE)
+		return;
+
+	extended = (cflags & REG_EXTENDED);
+	run = vStringNew ();
+	best = vStringNew ();
+
+	p = regex;
+	while (*p != '\0')
+	{
+		int c = *p;
+		const char *next;
+
+		if (c == '[')
+		{
+			c = -1;
+			next = skipBracket (p);
+		}
+		else if (extended && c == '(')
+		{
+			c = -1;
+			next = skipGroup (p + 1, extended);
+		}
+		else if (!extended && c == '\\' && p [1] == '(')
+		{
+			c = -1;
+			next = skipGroup (p + 2, extended);
+		}
+		else if (c == '\\' && p [1] != '\0')
+		{
+			if (strchr (extended? ".[]\\()*+?{}|^$/": ".[]\\*^$/", p [1]))
+				c = p [1];
+			else
+				c = -1;	/* a back reference or an escape sequence */
+			next = p + 2;
+		}
+		else if (c == '.' || c == '^' || c == '$')
+		{
+			c = -1;
+			next = p + 1;
+		}
+		else if (strchr (extended? "\\)*+?{}": "\\*", c))
+			break;
+		else
+			next = p + 1;
+
+		if (next == NULL)
+			break;
+		const char *q = parseQuantifier (next, extended);
+		if (q == NULL)
+			break;
+
+		if (c >= 0 && q == next)
+			vStringPut (run, c);
+		else
+		{
+			if (vStringLength (run) > vStringLength (best))
+				vStringCopy (best, run);
+			vStringClear (run);
+		}
+		p = q;
+	}
+	if (vStringLength (run) > vStringLength (best))
+		vStringCopy (best, run);
+
+	/* The prefix check covers a literal the same as the prefix. */
+	if (vStringLength (best) > 0
+		&& !(ptrn->prefix.literal && strcmp (ptrn->prefix.literal, vStringValue (best)) == 0))
+	{
+		ptrn->required.length = vStringLength (best);
+		ptrn->required.literal = vStringStrdup (best);
+	}
+
+	vStringDelete (best);
+	vStringDelete (run);
+}
+
+/* memchr is usually vectorized in libc; let it find the candidates. */
+static bool mayMatchRequired (const regexPattern *ptrn, const char *text, size_t length)
+{
+	const char *literal = ptrn->required.literal;
+	size_t literalLength = ptrn->required.length;
+	const char *end = text + length;
+
+	if (literal == NULL)
+		return true;
+
+	while ((size_t) (end - text) >= literalLength)
+	{
+		text = memchr (text, literal [0], end - text - literalLength + 1);
+		if (text == NULL)
+			return false;
+		if (memcmp (text + 1, literal + 1, literalLength - 1) == 0)
+			return true;
+		text++;
+	}
+	return false;
+}
+
 /* If a letter and/or a name are defined in kindSpec, return true. */
 static bool parseKinds (
 		const char* const kindSpec, char* const kindLetter, char** const kindName,
@@ -1694,8 +2047,15 @@ static bool matchRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
-	match = regexec (patbuf->pattern, vStringValue (line),
-			 BACK_REFERENCE_COUNT, pmatch, 0);
+	if (!mayMatchPrefix (patbuf, vStringValue (line))
+		|| !mayMatchRequired (patbuf, vStringValue (line), vStringLength (line)))
+	{
+		match = REG_NOMATCH;
+		entry->statistics.skip++;
+	}
+	else
+		match = regexec (patbuf->pattern, vStringValue (line),
+						 BACK_REFERENCE_COUNT, pmatch, 0);
 	if (match == 0)
 	{
 		result = true;
@@ -1756,6 +2116,13 @@ static bool matchMultilineRegexPattern (struct lregexControlBlock *lcb,
 	if (patbuf->disabled && *(patbuf->disabled))
 		return false;
 
+	if (!mayMatchRequired (patbuf, vStringValue (allLines), vStringLength (allLines)))
+	{
+		entry->statistics.unmatch++;
+		entry->statistics.skip++;
+		return false;
+	}
+
 	current = start = vStringValue (allLines);
 	do
 	{
@@ -2016,6 +2383,8 @@ static regexPattern *addTagRegexInternal (struct lregexControlBlock *lcb,
 												explictly_defined,
 												disabled);
 	rptr->pattern_string = escapeRegexPattern(regex);
+	analyzeRegexPrefix (rptr, regex, flags);
+	analyzeRegexRequired (rptr, regex, flags);
 
 	eFree (kindName);
 	if (description)
@@ -2089,6 +2458,8 @@ extern void addCallbackRegex (struct lregexControlBlock *lcb,
 		regexPattern *rptr = addCompiledCallbackPattern (lcb, cp, callback, flags,
 														 disabled, userData);
 		rptr->pattern_string = escapeRegexPattern(regex);
+		analyzeRegexPrefix (rptr, regex, flags);
+		analyzeRegexRequired (rptr, regex, flags);
 	}
 }
 
@@ -2453,8 +2824,14 @@ static struct regexTable * matchMultitableRegexTable (struct lregexControlBlock
 		if (ptrn->disabled && *(ptrn->disabled))
 			continue;
 
-		match = regexec (ptrn->pattern, current,
-						 BACK_REFERENCE_COUNT, pmatch, 0);
+		if (!mayMatchPrefix (ptrn, current))
+		{
+			match = REG_NOMATCH;
+			entry->statistics.skip++;
+		}
+		else
+			match = regexec (ptrn->pattern, current,
+							 BACK_REFERENCE_COUNT, pmatch, 0);
 
 		if (match == 0)
 		{
@@ -2631,8 +3008,38 @@ extern void extendRegexTable (struct lregexControlBlock *lcb, const char *src, c
 	}
 }
 
+static void printRegexTableEntryStatistics (regexTableEntry *entry)
+{
+	Assert (entry && entry->pattern);
+	fprintf(stderr, "%10u/%-10u%-40s ref: %d skip: %u\n",
+			entry->statistics.match,
+			entry->statistics.unmatch + entry->statistics.match,
+			entry->pattern->pattern_string,
+			entry->pattern->refcount,
+			entry->statistics.skip);
+}
+
 extern void printMultitableStatistics (struct lregexControlBlock *lcb)
 {
+	if (ptrArrayCount(lcb->entries[REG_PARSER_SINGLE_LINE]) > 0
+		|| ptrArrayCount(lcb->entries[REG_PARSER_MULTI_LINE]) > 0)
+	{
+		fprintf(stderr, "\nREGEX STATISTICS of %s\n", getLanguageName (lcb->owner));
+		fputs("==============================================\n", stderr);
+		for (int regptype = REG_PARSER_SINGLE_LINE; regptype <= REG_PARSER_MULTI_LINE; regptype++)
+		{
+			ptrArray *entries = lcb->entries[regptype];
+
+			if (ptrArrayCount(entries) == 0)
+				continue;
+			fprintf(stderr, "%s\n", (regptype == REG_PARSER_SINGLE_LINE)? "line": "mline");
+			fputs("-----------------------\n", stderr);
+			for (unsigned int i = 0; i < ptrArrayCount(entries); i++)
+				printRegexTableEntryStatistics (ptrArrayItem (entries, i));
+			fputc('\n', stderr);
+		}
+	}
+
 	if (ptrArrayCount(lcb->tables) == 0)
 		return;
 
@@ -2644,15 +3051,7 @@ extern void printMultitableStatistics (struct lregexControlBlock *lcb)
 		fprintf(stderr, "%s\n", table->name);
 		fputs("-----------------------\n", stderr);
 		for (unsigned int j = 0; j < ptrArrayCount(table->entries); j++)
-		{
-			regexTableEntry *entry = ptrArrayItem (table->entries, j);
-			Assert (entry && entry->pattern);
-			fprintf(stderr, "%10u/%-10u%-40s ref: %d\n",
-					entry->statistics.match,
-					entry->statistics.unmatch + entry->statistics.match,
-					entry->pattern->pattern_string,
-					entry->pattern->refcount);
-		}
+			printRegexTableEntryStatistics (ptrArrayItem (table->entries, j));
 		fputc('\n', stderr);
 	}
 }
@@ -57,6 +57,8 @@
 #include "keyword_p.h"
 #include "main_p.h"
 #include "options_p.h"
+#include "incremental_p.h"
+#include "jobs_p.h"
 #include "parse_p.h"
 #include "read_p.h"
 #include "routines_p.h"
@@ -81,16 +83,17 @@ static void *mainData;
 /*
 *   FUNCTION PROTOTYPES
 */
-static bool createTagsForEntry (const char *const entryName);
+static void createTagsForEntry (const char *const entryName);
+static void createTagsForNormalFile (const char *const fileName,
+									 const fileStatus *const status);
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
 #if defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
-static bool recurseUsingOpendir (const char *const dirName)
+static void recurseUsingOpendir (const char *const dirName)
 {
-	bool resize = false;
 	DIR *const dir = opendir (dirName);
 	if (dir == NULL)
 		error (WARNING | PERROR, "cannot recurse into directory \"%s\"", dirName);
@@ -111,38 +114,47 @@ static bool recurseUsingOpendir (const char *const dirName)
 					filePath = combinePathAndFile (dirName, entry->d_name);
 					free_p = true;
 				}
-				resize |= createTagsForEntry (filePath);
+#ifdef HAVE_STRUCT_DIRENT_D_TYPE
+				/* readdir() tells a regular file. Unless --incremental
+				 * wants its time stamp, stat'ing it is left to whoever
+				 * parses it; with --jobs, that is a worker process. */
+				if (entry->d_type == DT_REG && ! Option.incremental)
+				{
+					if (isExcludedFile (filePath, true))
+						verbose ("excluding \"%s\" (the early stage)\n", filePath);
+					else
+						createTagsForNormalFile (filePath, NULL);
+				}
+				else
+#endif
+					createTagsForEntry (filePath);
 				if (free_p)
 					eFree (filePath);
 			}
 		}
 		closedir (dir);
 	}
-	return resize;
 }
 
 #elif defined (HAVE__FINDFIRST)
 
-static bool createTagsForWildcardEntry (
+static void createTagsForWildcardEntry (
 		const char *const pattern, const size_t dirLength,
 		const char *const entryName)
 {
-	bool resize = false;
 	/* we must not recurse into the directories "." or ".." */
 	if (strcmp (entryName, ".") != 0  &&  strcmp (entryName, "..") != 0)
 	{
 		vString *const filePath = vStringNew ();
 		vStringNCopyS (filePath, pattern, dirLength);
 		vStringCatS (filePath, entryName);
-		resize = createTagsForEntry (vStringValue (filePath));
+		createTagsForEntry (vStringValue (filePath));
 		vStringDelete (filePath);
 	}
-	return resize;
 }
 
-static bool createTagsForWildcardUsingFindfirst (const char *const pattern)
+static void createTagsForWildcardUsingFindfirst (const char *const pattern)
 {
-	bool resize = false;
 	const size_t dirLength = baseFilename (pattern) - pattern;
 #if defined (HAVE__FINDFIRST)
 	struct _finddata_t fileInfo;
@@ -152,24 +164,22 @@ static bool createTagsForWildcardUsingFindfirst (const char *const pattern)
 		do
 		{
 			const char *const entry = (const char *) fileInfo.name;
-			resize |= createTagsForWildcardEntry (pattern, dirLength, entry);
+			createTagsForWildcardEntry (pattern, dirLength, entry);
 		} while (_findnext (hFile, &fileInfo) == 0);
 		_findclose (hFile);
 	}
 #endif
-	return resize;
 }
 
 #endif
 
 
-static bool recurseIntoDirectory (const char *const dirName)
+static void recurseIntoDirectory (const char *const dirName)
 {
 	static unsigned int recursionDepth = 0;
 
 	recursionDepth++;
 
-	bool resize = false;
 	if (isRecursiveLink (dirName))
 		verbose ("ignoring \"%s\" (recursive link)\n", dirName);
 	else if (! Option.recurse)
@@ -181,54 +191,73 @@ static bool recurseIntoDirectory (const char *const dirName)
 	{
 		verbose ("RECURSING into directory \"%s\"\n", dirName);
 #if defined (HAVE_OPENDIR) && (defined (HAVE_DIRENT_H) || defined (_MSC_VER))
-		resize = recurseUsingOpendir (dirName);
+		recurseUsingOpendir (dirName);
 #elif defined (HAVE__FINDFIRST)
 		{
 			vString *const pattern = vStringNew ();
 			vStringCopyS (pattern, dirName);
 			vStringPut (pattern, OUTPUT_PATH_SEPARATOR);
 			vStringCatS (pattern, "*.*");
-			resize = createTagsForWildcardUsingFindfirst (vStringValue (pattern));
+			createTagsForWildcardUsingFindfirst (vStringValue (pattern));
 			vStringDelete (pattern);
 		}
 #endif
 	}
 
 	recursionDepth--;
+}
 
-	return resize;
+static void createTagsForNormalFile (const char *const fileName,
+									 const fileStatus *const status)
+{
+	MIO *mio = NULL;
+
+	if (isExcludedFile (fileName, false))
+		verbose ("excluding \"%s\"\n", fileName);
+	else if (status && isInputFileUnchanged (fileName, status, &mio))
+		verbose ("skipping \"%s\" (unchanged)\n", fileName);
+	else if (useJobs ())
+		queueJob (fileName);
+	else if (mio)
+		parseFileWithMio (fileName, mio, NULL);
+	else
+		parseFile (fileName);
+
+	if (mio)
+		mio_unref (mio);
 }
 
-static bool createTagsForEntry (const char *const entryName)
+static void createTagsForEntry (const char *const entryName)
 {
-	bool resize = false;
-	fileStatus *status = eStat (entryName);
+	fileStatus *status;
 
 	Assert (entryName != NULL);
+	/* An excluded directory is pruned here without even stat'ing it. */
 	if (isExcludedFile (entryName, true))
+	{
 		verbose ("excluding \"%s\" (the early stage)\n", entryName);
-	else if (status->isSymbolicLink  &&  ! Option.followLinks)
+		return;
+	}
+
+	status = eStat (entryName);
+	if (status->isSymbolicLink  &&  ! Option.followLinks)
 		verbose ("ignoring \"%s\" (symbolic link)\n", entryName);
 	else if (! status->exists)
 		error (WARNING | PERROR, "cannot open input file \"%s\"", entryName);
 	else if (status->isDirectory)
-		resize = recurseIntoDirectory (entryName);
+		recurseIntoDirectory (entryName);
 	else if (! status->isNormalFile)
 		verbose ("ignoring \"%s\" (special file)\n", entryName);
-	else if (isExcludedFile (entryName, false))
-		verbose ("excluding \"%s\"\n", entryName);
 	else
-		resize = parseFile (entryName);
+		createTagsForNormalFile (entryName, status);
 
 	eStatFree (status);
-	return resize;
 }
 
 #ifdef MANUAL_GLOBBING
 
-static bool createTagsForWildcardArg (const char *const arg)
+static void createTagsForWildcardArg (const char *const arg)
 {
-	bool resize = false;
 	vString *const pattern = vStringNewInit (arg);
 	char *patternS = vStringValue (pattern);
 
@@ -242,18 +271,15 @@ static bool createTagsForWildcardArg (const char *const arg)
 		vStringPut (pattern, OUTPUT_PATH_SEPARATOR);
 		vStringCatS (pattern, "*.*");
 	}
-	resize |= createTagsForWildcardUsingFindfirst (patternS);
+	createTagsForWildcardUsingFindfirst (patternS);
 #endif
 	vStringDelete (pattern);
-	return resize;
 }
 
 #endif
 
-static bool createTagsForArgs (cookedArgs *const args)
+static void createTagsForArgs (cookedArgs *const args)
 {
-	bool resize = false;
-
 	/*  Generate tags for each argument on the command line.
 	 */
 	while (! cArgOff (args))
@@ -261,28 +287,31 @@ static bool createTagsForArgs (cookedArgs *const args)
 		const char *const arg = cArgItem (args);
 
 #ifdef MANUAL_GLOBBING
-		resize |= createTagsForWildcardArg (arg);
+		createTagsForWildcardArg (arg);
 #else
-		resize |= createTagsForEntry (arg);
+		createTagsForEntry (arg);
 #endif
 		cArgForth (args);
+		/* The queued files must be parsed with the options given so far. */
+		if (! cArgOff (args) && cArgIsOption (args))
+			runJobs ();
 		parseCmdlineOptions (args);
 	}
-	return resize;
 }
 
 /*  Read from an opened file a list of file names for which to generate tags.
  */
-static bool createTagsFromFileInput (FILE *const fp, const bool filter)
+static void createTagsFromFileInput (FILE *const fp, const bool filter)
 {
-	bool resize = false;
 	if (fp != NULL)
 	{
 		cookedArgs *args = cArgNewFromLineFile (fp);
+		if (! cArgOff (args) && cArgIsOption (args))
+			runJobs ();
 		parseCmdlineOptions (args);
 		while (! cArgOff (args))
 		{
-			resize |= createTagsForEntry (cArgItem (args));
+			createTagsForEntry (cArgItem (args));
 			if (filter)
 			{
 				if (Option.filterTerminator != NULL)
@@ -290,30 +319,29 @@ static bool createTagsFromFileInput (FILE *const fp, const bool filter)
 				fflush (stdout);
 			}
 			cArgForth (args);
+			if (! cArgOff (args) && cArgIsOption (args))
+				runJobs ();
 			parseCmdlineOptions (args);
 		}
 		cArgDelete (args);
 	}
-	return resize;
 }
 
 /*  Read from a named file a list of file names for which to generate tags.
  */
-static bool createTagsFromListFile (const char *const fileName)
+static void createTagsFromListFile (const char *const fileName)
 {
-	bool resize;
 	Assert (fileName != NULL);
 	if (strcmp (fileName, "-") == 0)
-		resize = createTagsFromFileInput (stdin, false);
+		createTagsFromFileInput (stdin, false);
 	else
 	{
 		FILE *const fp = fopen (fileName, "r");
 		if (fp == NULL)
 			error (FATAL | PERROR, "cannot open list file \"%s\"", fileName);
-		resize = createTagsFromFileInput (fp, false);
+		createTagsFromFileInput (fp, false);
 		fclose (fp);
 	}
-	return resize;
 }
 
 static bool etagsInclude (void)
@@ -335,7 +363,6 @@ static void runMainLoop (cookedArgs *args)
 static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 {
 	clock_t timeStamps [3];
-	bool resize = false;
 	bool files = (bool)(! cArgOff (args) || Option.fileList != NULL
 							  || Option.filter);
 
@@ -357,25 +384,26 @@ static void batchMakeTags (cookedArgs *args, void *user CTAGS_ATTR_UNUSED)
 	if (! cArgOff (args))
 	{
 		verbose ("Reading command line arguments\n");
-		resize = createTagsForArgs (args);
+		createTagsForArgs (args);
 	}
 	if (Option.fileList != NULL)
 	{
 		verbose ("Reading list file\n");
-		resize = (bool) (createTagsFromListFile (Option.fileList) || resize);
+		createTagsFromListFile (Option.fileList);
 	}
 	if (Option.filter)
 	{
 		verbose ("Reading filter input\n");
-		resize = (bool) (createTagsFromFileInput (stdin, true) || resize);
+		createTagsFromFileInput (stdin, true);
 	}
 	if (! files  &&  Option.recurse)
-		resize = recurseIntoDirectory (".");
+		recurseIntoDirectory (".");
+	runJobs ();
 
 	timeStamp (1);
 
 	if ((! Option.filter) && (!Option.printLanguage))
-		closeTagFile (resize);
+		closeTagFile ();
 
 	timeStamp (2);
 
@@ -456,7 +484,7 @@ void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
 				if (iargs->sandbox) {
 					error (FATAL,
 						   "invalid request in sandbox submode: reading file contents from a file is limited");
-					closeTagFile (false);
+					closeTagFile ();
 					goto next;
 				}
 
@@ -471,7 +499,7 @@ void interactiveLoop (cookedArgs *args CTAGS_ATTR_UNUSED, void *user)
 				mio_unref (mio);
 			}
 
-			closeTagFile (false);
+			closeTagFile ();
 			fputs ("{\"_type\": \"completed\", \"command\": \"generate-tags\"}\n", stdout);
 			fflush(stdout);
 		}
@@ -588,6 +616,7 @@ extern int ctags_cli_main (int argc CTAGS_ATTR_UNUSED, char **argv)
 	 */
 	cArgDelete (args);
 	freeKeywordTable ();
+	freeJobsResources ();
 	freeRoutineResources ();
 	freeInputFileResources ();
 	freeTagFileResources ();
@@ -43,6 +43,14 @@
 #include <stdlib.h>
 #include <limits.h>
 
+#if defined (HAVE_MMAP) && defined (HAVE_SYS_MMAN_H)
+# define USE_MMAP
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
 #ifdef READTAGS_DSL
 #define xMalloc(n,Type)    (Type *)eMalloc((size_t)(n) * sizeof (Type))
 #define xRealloc(p,n,Type) (Type *)eRealloc((p), (n) * sizeof (Type))
@@ -141,6 +149,11 @@ struct _MIO {
 		struct {
 			FILE *fp;
 			MIOFCloseFunc close_func;
+			/* The write buffer set with mio_file_set_write_buffer() */
+			unsigned char *wbuf;
+			size_t wlen;
+			size_t wsize;
+			bool werror;
 		} file;
 		struct {
 			unsigned char *buf;
@@ -152,6 +165,7 @@ struct _MIO {
 			MIODestroyNotify free_func;
 			bool error;
 			bool eof;
+			bool mapped;
 		} mem;
 	} impl;
 	MIOUserData udata;
@@ -208,6 +222,10 @@ MIO *mio_new_file_full (const char *filename,
 			mio->type = MIO_TYPE_FILE;
 			mio->impl.file.fp = fp;
 			mio->impl.file.close_func = close_func;
+			mio->impl.file.wbuf = NULL;
+			mio->impl.file.wlen = 0;
+			mio->impl.file.wsize = 0;
+			mio->impl.file.werror = false;
 			mio->refcount = 1;
 			mio->udata.d = NULL;
 			mio->udata.f = NULL;
@@ -269,6 +287,10 @@ MIO *mio_new_fp (FILE *fp, MIOFCloseFunc close_func)
 		mio->type = MIO_TYPE_FILE;
 		mio->impl.file.fp = fp;
 		mio->impl.file.close_func = close_func;
+		mio->impl.file.wbuf = NULL;
+		mio->impl.file.wlen = 0;
+		mio->impl.file.wsize = 0;
+		mio->impl.file.werror = false;
 		mio->refcount = 1;
 		mio->udata.d = NULL;
 		mio->udata.f = NULL;
@@ -277,6 +299,67 @@ MIO *mio_new_fp (FILE *fp, MIOFCloseFunc close_func)
 	return mio;
 }
 
+/* Pass the data in the write buffer to the FILE object. */
+static int file_flush_write_buffer (MIO *mio)
+{
+	int rv = 0;
+
+	if (mio->impl.file.wlen > 0)
+	{
+		if (fwrite (mio->impl.file.wbuf, 1, mio->impl.file.wlen,
+					mio->impl.file.fp) != mio->impl.file.wlen)
+		{
+			mio->impl.file.werror = true;
+			rv = EOF;
+		}
+		mio->impl.file.wlen = 0;
+	}
+	return rv;
+}
+
+static bool file_buffered_write (MIO *mio, const void *ptr, size_t len)
+{
+	if (len > mio->impl.file.wsize - mio->impl.file.wlen
+		&& file_flush_write_buffer (mio) != 0)
+		return false;
+
+	if (len >= mio->impl.file.wsize)
+		return fwrite (ptr, 1, len, mio->impl.file.fp) == len;
+
+	memcpy (mio->impl.file.wbuf + mio->impl.file.wlen, ptr, len);
+	mio->impl.file.wlen += len;
+	return true;
+}
+
+/**
+ * mio_file_set_write_buffer:
+ * @mio: A #MIO object working on a file
+ * @size: Size of the buffer in bytes, or 0 to stop buffering
+ *
+ * Makes the data written to a #MIO stream gathered in a buffer of @size
+ * bytes, and passed to the underlying #FILE object when the buffer is full.
+ * This saves the calls of the stdio functions, each of which locks the
+ * #FILE object, for a stream written in many small pieces.
+ *
+ * The buffer is flushed before reading, seeking, getting the position of,
+ * flushing, and destroying the stream, and before mio_file_get_fp() returns.
+ * An error in writing the buffer is reported by mio_error().
+ *
+ * Returns: 0 on success, -1 if @mio doesn't work on a file.
+ */
+int mio_file_set_write_buffer (MIO *mio, size_t size)
+{
+	if (mio->type != MIO_TYPE_FILE)
+		return -1;
+
+	file_flush_write_buffer (mio);
+	if (mio->impl.file.wbuf)
+		eFree (mio->impl.file.wbuf);
+	mio->impl.file.wbuf = (size > 0)? eMalloc (size): NULL;
+	mio->impl.file.wsize = size;
+	return 0;
+}
+
 /**
  * mio_new_memory:
  * @data: Initial data (may be %NULL)
@@ -333,6 +416,7 @@ MIO *mio_new_memory (unsigned char *data,
 		mio->impl.mem.free_func = free_func;
 		mio->impl.mem.eof = false;
 		mio->impl.mem.error = false;
+		mio->impl.mem.mapped = false;
 		mio->refcount = 1;
 		mio->udata.d = NULL;
 		mio->udata.f = NULL;
@@ -341,6 +425,53 @@ MIO *mio_new_memory (unsigned char *data,
 	return mio;
 }
 
+/**
+ * mio_new_mapped_file:
+ * @filename: Filename to open
+ *
+ * Creates a new read-only #MIO object by mapping the contents of a regular
+ * file to memory. The object has the type %MIO_TYPE_MEMORY, so
+ * mio_memory_get_data() returns the mapped region. Writing to the object
+ * fails.
+ *
+ * Returns: A new #MIO on success, or %NULL on failure, or if memory mapping
+ *          is not supported, or the file is empty.
+ */
+MIO *mio_new_mapped_file (const char *filename)
+{
+#ifdef USE_MMAP
+	MIO *mio;
+	int fd;
+	struct stat st;
+	void *addr;
+
+	fd = open (filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode) || st.st_size <= 0
+		|| (unsigned long long) st.st_size > (size_t) -1)
+	{
+		close (fd);
+		return NULL;
+	}
+
+	addr = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	mio = mio_new_memory (addr, (size_t) st.st_size, NULL, NULL);
+	if (mio)
+		mio->impl.mem.mapped = true;
+	else
+		munmap (addr, (size_t) st.st_size);
+	return mio;
+#else
+	return NULL;
+#endif
+}
+
 /**
  * mio_new_mio:
  * @base: The original mio
@@ -434,7 +565,10 @@ FILE *mio_file_get_fp (MIO *mio)
 	FILE *fp = NULL;
 
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		fp = mio->impl.file.fp;
+	}
 
 	return fp;
 }
@@ -491,13 +625,26 @@ int mio_unref (MIO *mio)
 
 		if (mio->type == MIO_TYPE_FILE)
 		{
+			if (file_flush_write_buffer (mio) != 0)
+				rv = EOF;
+			if (mio->impl.file.wbuf)
+				eFree (mio->impl.file.wbuf);
+			mio->impl.file.wbuf = NULL;
 			if (mio->impl.file.close_func)
-				rv = mio->impl.file.close_func (mio->impl.file.fp);
+			{
+				int r = mio->impl.file.close_func (mio->impl.file.fp);
+				if (rv == 0)
+					rv = r;
+			}
 			mio->impl.file.close_func = NULL;
 			mio->impl.file.fp = NULL;
 		}
 		else if (mio->type == MIO_TYPE_MEMORY)
 		{
+#ifdef USE_MMAP
+			if (mio->impl.mem.mapped)
+				munmap (mio->impl.mem.buf, mio->impl.mem.allocated_size);
+#endif
 			if (mio->impl.mem.free_func)
 				mio->impl.mem.free_func (mio->impl.mem.buf);
 			mio->impl.mem.buf = NULL;
@@ -539,7 +686,10 @@ size_t mio_read (MIO *mio,
 				 size_t nmemb)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return fread (ptr_, size, nmemb, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		size_t n_read = 0;
@@ -596,7 +746,7 @@ static int mem_try_resize (MIO *mio, size_t new_size)
 {
 	int success = false;
 
-	if (mio->impl.mem.realloc_func)
+	if (mio->impl.mem.realloc_func && ! mio->impl.mem.mapped)
 	{
 		if (new_size == ULONG_MAX)
 		{
@@ -668,7 +818,9 @@ static int mem_try_ensure_space (MIO *mio, size_t n)
 {
 	int success = true;
 
-	if (mio->impl.mem.pos + n > mio->impl.mem.size)
+	if (mio->impl.mem.mapped)
+		success = false;
+	else if (mio->impl.mem.pos + n > mio->impl.mem.size)
 		success = mem_try_resize (mio, mio->impl.mem.pos + n);
 
 	return success;
@@ -692,7 +844,11 @@ size_t mio_write (MIO *mio,
 				  size_t nmemb)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		if (mio->impl.file.wbuf)
+			return file_buffered_write (mio, ptr, size * nmemb)? nmemb: 0;
 		return fwrite (ptr, size, nmemb, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		size_t n_written = 0;
@@ -729,7 +885,14 @@ size_t mio_write (MIO *mio,
 int mio_putc (MIO *mio, int c)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		if (mio->impl.file.wbuf)
+		{
+			unsigned char b = (unsigned char)c;
+			return file_buffered_write (mio, &b, 1)? (int)b: EOF;
+		}
 		return fputc (c, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		int rv = EOF;
@@ -762,7 +925,11 @@ int mio_putc (MIO *mio, int c)
 int mio_puts (MIO *mio, const char *s)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		if (mio->impl.file.wbuf)
+			return file_buffered_write (mio, s, strlen (s))? 1: EOF;
 		return fputs (s, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		int rv = EOF;
@@ -800,7 +967,28 @@ int mio_puts (MIO *mio, const char *s)
 int mio_vprintf (MIO *mio, const char *format, va_list ap)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		if (mio->impl.file.wbuf)
+		{
+			size_t space = mio->impl.file.wsize - mio->impl.file.wlen;
+			va_list ap_copy;
+			int n;
+
+			/* Format into the buffer directly if the output fits in it. */
+			va_copy (ap_copy, ap);
+			n = vsnprintf ((char *)mio->impl.file.wbuf + mio->impl.file.wlen,
+						   space, format, ap_copy);
+			va_end (ap_copy);
+			if (n >= 0 && (size_t)n < space)
+			{
+				mio->impl.file.wlen += (size_t)n;
+				return n;
+			}
+			if (file_flush_write_buffer (mio) != 0)
+				return -1;
+		}
 		return vfprintf (mio->impl.file.fp, format, ap);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		int rv = -1;
@@ -884,7 +1072,10 @@ int mio_printf (MIO *mio, const char *format, ...)
 int mio_getc (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return fgetc (mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		int rv = EOF;
@@ -931,7 +1122,10 @@ int mio_getc (MIO *mio)
 int mio_ungetc (MIO *mio, int ch)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return ungetc (ch, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		int rv = EOF;
@@ -967,7 +1161,10 @@ int mio_ungetc (MIO *mio, int ch)
 char *mio_gets (MIO *mio, char *s, size_t size)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return fgets (s, (int)size, mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		char *rv = NULL;
@@ -1020,6 +1217,48 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 	}
 }
 
+/**
+ * mio_memory_gets:
+ * @mio: A #MIO object
+ * @length: (out): Return location for the length of the returned line
+ *
+ * Reads a line from a #MIO memory stream like mio_gets(), but returns the
+ * line in the underlying memory buffer instead of copying it. The line
+ * includes the new-line character if any, and is not terminated with '\0'.
+ *
+ * Returns: The line on success, or %NULL at the end of the stream, or if
+ *          the stream is not a memory stream or has an ungotten character.
+ */
+const unsigned char *mio_memory_gets (MIO *mio, size_t *length)
+{
+	const unsigned char *line;
+	const unsigned char *eol;
+	size_t rest;
+
+	if (mio->type != MIO_TYPE_MEMORY || mio->impl.mem.ungetch != EOF)
+		return NULL;
+
+	if (mio->impl.mem.pos >= mio->impl.mem.size)
+	{
+		mio->impl.mem.eof = true;
+		return NULL;
+	}
+
+	line = mio->impl.mem.buf + mio->impl.mem.pos;
+	rest = mio->impl.mem.size - mio->impl.mem.pos;
+	eol = memchr (line, '\n', rest);
+	if (eol)
+		*length = eol - line + 1;
+	else
+	{
+		*length = rest;
+		mio->impl.mem.eof = true;
+	}
+	mio->impl.mem.pos += *length;
+
+	return line;
+}
+
 /**
  * mio_clearerr:
  * @mio: A #MIO object
@@ -1030,7 +1269,10 @@ char *mio_gets (MIO *mio, char *s, size_t size)
 void mio_clearerr (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
 		clearerr (mio->impl.file.fp);
+		mio->impl.file.werror = false;
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		mio->impl.mem.error = false;
@@ -1074,7 +1316,7 @@ int mio_eof (MIO *mio)
 int mio_error (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
-		return ferror (mio->impl.file.fp);
+		return ferror (mio->impl.file.fp) || mio->impl.file.werror;
 	else if (mio->type == MIO_TYPE_MEMORY)
 		return mio->impl.mem.error != false;
 	else
@@ -1101,7 +1343,10 @@ int mio_error (MIO *mio)
 int mio_seek (MIO *mio, long offset, int whence)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return fseek (mio->impl.file.fp, offset, whence);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		/* FIXME: should we support seeking out of bounds like lseek() seems to do? */
@@ -1174,7 +1419,10 @@ int mio_seek (MIO *mio, long offset, int whence)
 long mio_tell (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		return ftell (mio->impl.file.fp);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		long rv = -1;
@@ -1208,7 +1456,11 @@ long mio_tell (MIO *mio)
 void mio_rewind (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		rewind (mio->impl.file.fp);
+		mio->impl.file.werror = false;
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		mio->impl.mem.pos = 0;
@@ -1238,7 +1490,10 @@ int mio_getpos (MIO *mio, MIOPos *pos)
 
 	pos->type = mio->type;
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		rv = fgetpos (mio->impl.file.fp, &pos->impl.file);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		rv = -1;
@@ -1302,7 +1557,10 @@ int mio_setpos (MIO *mio, MIOPos *pos)
 #endif /* MIO_DEBUG */
 
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		file_flush_write_buffer (mio);
 		rv = fsetpos (mio->impl.file.fp, &pos->impl.file);
+	}
 	else if (mio->type == MIO_TYPE_MEMORY)
 	{
 		rv = -1;
@@ -1335,7 +1593,11 @@ int mio_setpos (MIO *mio, MIOPos *pos)
 int mio_flush (MIO *mio)
 {
 	if (mio->type == MIO_TYPE_FILE)
+	{
+		if (file_flush_write_buffer (mio) != 0)
+			return EOF;
 		return fflush (mio->impl.file.fp);
+	}
 	return 0;
 }
 
@@ -123,11 +123,13 @@ MIO *mio_new_memory (unsigned char *data,
 					 MIOReallocFunc realloc_func,
 					 MIODestroyNotify free_func);
 
+MIO *mio_new_mapped_file (const char *filename);
 MIO *mio_new_mio    (MIO *base, long start, long size);
 MIO *mio_ref        (MIO *mio);
 
 int mio_unref (MIO *mio);
 FILE *mio_file_get_fp (MIO *mio);
+int mio_file_set_write_buffer (MIO *mio, size_t size);
 unsigned char *mio_memory_get_data (MIO *mio, size_t *size);
 size_t mio_read (MIO *mio,
 				 void *ptr,
@@ -139,6 +141,7 @@ size_t mio_write (MIO *mio,
 				  size_t nmemb);
 int mio_getc (MIO *mio);
 char *mio_gets (MIO *mio, char *s, size_t size);
+const unsigned char *mio_memory_gets (MIO *mio, size_t *length);
 int mio_ungetc (MIO *mio, int ch);
 int mio_putc (MIO *mio, int c);
 int mio_puts (MIO *mio, const char *s);
@@ -22,11 +22,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>  /* to declare isspace () */
+#include <errno.h>
+#include <limits.h>
 
 #include "ctags.h"
 #include "debug.h"
 #include "entry_p.h"
 #include "field_p.h"
+#include "globset_p.h"
 #include "gvars.h"
 #include "keyword_p.h"
 #include "parse_p.h"
@@ -36,6 +39,7 @@
 #include "param_p.h"
 #include "error_p.h"
 #include "interactive_p.h"
+#include "server_p.h"
 #include "writer_p.h"
 #include "trace.h"
 
@@ -61,6 +65,7 @@
 #define PATTERN_START '('
 #define PATTERN_STOP  ')'
 #define IGNORE_SEPARATORS   ", \t\n"
+#define JOBS_MAX 256
 
 #ifndef DEFAULT_FILE_FORMAT
 # define DEFAULT_FILE_FORMAT  2
@@ -120,10 +125,21 @@ typedef const struct sBooleanOption {
 static bool NonOptionEncountered = false;
 static stringList *OptionFiles;
 
+/* The options processed so far, except the ones not changing the tags
+ * made from an input file (--cache-dir). The name of the tag file and
+ * the list of input files (-f, -o, -L) are not in it; the name of the
+ * input file in the tag file is a part of the cache key. */
+static vString *OptionsFingerprint;
+static const char *const OptionsNotFingerprinted [] = {
+	"cache-dir", "exclude", "exclude-exception", "incremental", "jobs", "quiet", "recurse",
+	"_server", "sort", "sort-in-memory", "sort-memory", "tag-index", "totals", "verbose",
+};
+
 typedef stringList searchPathList;
 static searchPathList *OptlibPathList;
 
 static stringList *Excluded, *ExcludedException;
+static globSet *ExcludedSet, *ExcludedExceptionSet; /* compiled lazily */
 static bool FilesRequired = true;
 static bool SkipConfiguration;
 
@@ -136,6 +152,7 @@ bool ctags_verbose = false;
 
 optionValues Option = {
 	.append = false,
+	.incremental = false,
 	.backward = false,
 	.etags = false,
 	.locate =
@@ -172,7 +189,13 @@ optionValues Option = {
 	.patternLengthLimit = 96,
 	.putFieldPrefix = false,
 	.maxRecursionDepth = 0xffffffff,
+	.jobs = 1,
+	.sortMemory = 64UL * 1024 * 1024,
+	.sortInMemory = false,
+	.cacheDir = NULL,
+	.tagIndex = false,
 	.interactive = false,
+	.server = false,
 #ifdef WIN32
 	.useSlashAsFilenameSeparator = FILENAME_SEP_UNSET,
 #endif
@@ -241,6 +264,8 @@ static optionDescription LongOptionDescription [] = {
  {1,"       for LANG."},
  {1,"  --append=[yes|no]"},
  {1,"       Should tags should be appended to existing tag file [no]?"},
+ {1,"  --cache-dir=DIR"},
+ {1,"       Reuse the tags made from an input file with the same contents, saved in DIR."},
  {1,"  --etags-include=file"},
  {1,"       Include reference to 'file' in Emacs-style tag file (requires -e)."},
  {1,"  --exclude=pattern"},
@@ -289,12 +314,16 @@ static optionDescription LongOptionDescription [] = {
  {1,"       Print this option summary including experimental features."},
  {1,"  --if0=[yes|no]"},
  {1,"       Should code within #if 0 conditional branches be parsed [no]?"},
+ {1,"  --incremental=[yes|no]"},
+ {1,"       Reparse only the input files changed since the tag file was made [no]."},
 #ifdef HAVE_ICONV
  {1,"  --input-encoding=encoding"},
  {1,"       Specify encoding of all input files."},
  {1,"  --input-encoding-<LANG>=encoding"},
  {1,"       Specify encoding of the LANG input files."},
 #endif
+ {1,"  --jobs=N"},
+ {1,"       Parse input files with N worker processes; 1 disables parallelism [1]."},
  {1,"  --kinddef-<LANG>=letter,name,desc"},
  {1,"       Define new kind for <LANG>."},
  {1,"  --kinds-<LANG>=[+|-]kinds, or"},
@@ -382,11 +411,7 @@ static optionDescription LongOptionDescription [] = {
  {1,"       The encoding to write the tag file in. Defaults to UTF-8 if --input-encoding"},
  {1,"       is specified, otherwise no conversion is performed."},
 #endif
- {0,"  --output-format=u-ctags|e-ctags|etags|xref"
-#ifdef HAVE_JANSSON
-  "|json"
-#endif
- },
+ {0,"  --output-format=u-ctags|e-ctags|etags|xref|json"},
  {0,"      Specify the output format. [u-ctags]"},
  {1,"  --param-<LANG>:name=argument"},
  {1,"       Set <LANG> specific parameter. Available parameters can be listed with --list-params."},
@@ -416,6 +441,13 @@ static optionDescription LongOptionDescription [] = {
  {1,"       Enable/disable tag roles for kinds of language <LANG>."},
  {0,"  --sort=[yes|no|foldcase]"},
  {0,"       Should tags be sorted (optionally ignoring case) [yes]?"},
+ {1,"  --sort-in-memory=[yes|no]"},
+ {1,"       Keep the tags in memory until they are sorted, instead of sorting the tag file [no]."},
+ {1,"  --sort-memory=SIZE"},
+ {1,"       Limit the memory used for sorting tags to SIZE bytes (suffix k, m, or g allowed) [64m]."},
+ {1,"       Sorted runs are spilled to temporary files when exceeding it."},
+ {1,"  --tag-index=[yes|no]"},
+ {1,"       Write an index of the tag file for readtags to find tags quickly [no]."},
  {0,"  --tag-relative=[yes|no|always|never]"},
  {0,"       Should paths be relative to location of tag file [no; yes when -e]?"},
  {0,"       always: be relative even if input files are passed in with absolute paths" },
@@ -487,6 +519,9 @@ static optionDescription ExperimentalLongOptionDescription [] = {
  {1,"  --_scopesep-<LANG>=[parent_kind_letter]/child_kind_letter:separator"},
  {1,"       Specify scope separator between <PARENT_KIND> and <KIND>."},
  {1,"       * as a kind letter matches any kind."},
+ {1,"  --_server[=socket]"},
+ {1,"       Enter server mode; serve requests for tags from stdin, or from"},
+ {1,"       the connections to the Unix domain socket."},
  {1,"  --_tabledef-<LANG>=name"},
  {1,"       Define new regex table for <LANG>."},
 #ifdef DO_TRACING
@@ -551,8 +586,8 @@ static struct Feature {
 #ifdef HAVE_LIBXML
 	{"xpath", "linked with library for parsing xml input"},
 #endif
-#ifdef HAVE_JANSSON
 	{"json", "supports json format output"},
+#ifdef HAVE_JANSSON
 	{"interactive", "accepts source code from stdin"},
 #endif
 #ifdef HAVE_SECCOMP
@@ -745,6 +780,24 @@ extern void checkOptions (void)
 		if (isDestinationStdout ())
 			error (FATAL, "%s tags to stdout", notice);
 	}
+	if (Option.incremental)
+	{
+		notice = "incremental mode is not compatible with";
+		if (isDestinationStdout ())
+			error (FATAL, "%s tags to stdout", notice);
+		if (Option.append)
+			error (FATAL, "%s append mode", notice);
+		if (! writerCanUpdateTagFile ())
+			error (FATAL, "%s the output format", notice);
+	}
+	if (Option.tagIndex)
+	{
+		notice = "tag index is not compatible with";
+		if (isDestinationStdout ())
+			error (FATAL, "%s tags to stdout", notice);
+		if (! writerCanUpdateTagFile ())
+			error (FATAL, "%s the output format", notice);
+	}
 	if (Option.filter)
 	{
 		notice = "filter mode";
@@ -837,7 +890,6 @@ static void setXrefMode (void)
 	setTagWriter (WRITER_XREF, NULL);
 }
 
-#ifdef HAVE_JANSSON
 static void setJsonMode (void)
 {
 	enablePtag (PTAG_JSON_OUTPUT_VERSION, true);
@@ -845,7 +897,6 @@ static void setJsonMode (void)
 	enablePtag (PTAG_FILE_FORMAT, false);
 	setTagWriter (WRITER_JSON, NULL);
 }
-#endif
 
 /*
  *  Cooked argument parsing
@@ -1139,10 +1190,22 @@ static void processEtagsInclude (
 	}
 }
 
+static void freeGlobSet (globSet **set)
+{
+	if (*set != NULL)
+	{
+		globSetDelete (*set);
+		*set = NULL;
+	}
+}
+
 static void processExcludeOptionCommon (
-	stringList** list, const char *const optname, const char *const parameter)
+	stringList** list, globSet **set,
+	const char *const optname, const char *const parameter)
 {
 	const char *const fileName = parameter + 1;
+
+	freeGlobSet (set);
 	if (parameter [0] == '\0')
 		freeList (list);
 	else if (parameter [0] == '@')
@@ -1172,13 +1235,27 @@ static void processExcludeOptionCommon (
 static void processExcludeOption (
 		const char *const option, const char *const parameter)
 {
-	processExcludeOptionCommon (&Excluded, option, parameter);
+	processExcludeOptionCommon (&Excluded, &ExcludedSet, option, parameter);
 }
 
 static void processExcludeExceptionOption (
 		const char *const option, const char *const parameter)
 {
-	processExcludeOptionCommon (&ExcludedException, option, parameter);
+	processExcludeOptionCommon (&ExcludedException, &ExcludedExceptionSet,
+								option, parameter);
+}
+
+static bool excludeListMatched (const stringList *const list, globSet **set,
+								const char *const name, const char *const base)
+{
+	if (list == NULL || stringListCount (list) == 0)
+		return false;
+
+	if (*set == NULL)
+		*set = globSetNewFromList (list);
+
+	return (globSetMatched (*set, base)
+			|| (name != base && globSetMatched (*set, name)));
 }
 
 extern bool isExcludedFile (const char* const name,
@@ -1192,24 +1269,12 @@ extern bool isExcludedFile (const char* const name,
 		&& stringListCount (ExcludedException) > 0)
 		return false;
 
-	if (Excluded != NULL)
-	{
-		result = stringListFileMatched (Excluded, base);
-		if (! result  &&  name != base)
-			result = stringListFileMatched (Excluded, name);
-	}
-
-	if (result && ExcludedException != NULL)
-	{
-		bool result_exception;
+	result = excludeListMatched (Excluded, &ExcludedSet, name, base);
 
-		result_exception = stringListFileMatched (ExcludedException, base);
-		if (! result_exception && name != base)
-			result_exception = stringListFileMatched (ExcludedException, name);
+	if (result
+		&& excludeListMatched (ExcludedException, &ExcludedExceptionSet, name, base))
+		result = false;
 
-		if (result_exception)
-			result = false;
-	}
 	return result;
 }
 
@@ -1675,6 +1740,26 @@ static void processInteractiveOption (
 }
 #endif
 
+static void processServerOption (
+		const char *const option,
+		const char *const parameter)
+{
+	static struct serverModeArgs args;
+
+	if (parameter && *parameter != '\0')
+	{
+		if (! isServerSocketSupported ())
+			error (FATAL, "--%s=socket is not supported on this platform", option);
+		args.socketName = eStrdup (parameter);
+	}
+
+	/* The tags for each request are written to stdout as in filter mode. */
+	Option.server = true;
+	Option.filter = true;
+	Option.sortInMemory = true;
+	setMainLoop (serverLoop, &args);
+}
+
 static void processIf0Option (const char *const option,
 							  const char *const parameter)
 {
@@ -2388,10 +2473,8 @@ static void processOutputFormat (const char *const option CTAGS_ATTR_UNUSED,
 		setEtagsMode ();
 	else if (strcmp (parameter, "xref") == 0)
 		setXrefMode ();
-#ifdef HAVE_JANSSON
 	else if (strcmp (parameter, "json") == 0)
 		setJsonMode ();
-#endif
 	else
 		error (FATAL, "unknown output format name supplied for \"%s=%s\"", option, parameter);
 }
@@ -2755,6 +2838,51 @@ static void processMaxRecursionDepthOption (const char *const option, const char
 	Option.maxRecursionDepth = atol(parameter);
 }
 
+static void processJobsOption (const char *const option, const char *const parameter)
+{
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	if (!strToUInt(parameter, 0, &Option.jobs) || Option.jobs < 1)
+		error (FATAL, "-%s: Invalid number of jobs", option);
+	if (Option.jobs > JOBS_MAX)
+		error (FATAL, "-%s: Too many jobs: %u (the maximum is %d)",
+			   option, Option.jobs, JOBS_MAX);
+}
+
+static void processCacheDirOption (const char *const option, const char *const parameter)
+{
+	freeString (&Option.cacheDir);
+	if (parameter [0] != '\0')
+		Option.cacheDir = stringCopy (parameter);
+}
+
+static void processSortMemoryOption (const char *const option, const char *const parameter)
+{
+	unsigned long size;
+	char *end;
+
+	if (parameter == NULL || parameter[0] == '\0')
+		error (FATAL, "A parameter is needed after \"%s\" option", option);
+
+	errno = 0;
+	size = strtoul (parameter, &end, 10);
+	if (errno != 0 || end == parameter || parameter[0] == '-')
+		error (FATAL, "-%s: Invalid memory size", option);
+
+	unsigned long unit = 1;
+	switch (*end)
+	{
+	case 'g': case 'G': unit *= 1024;	/* Fall through */
+	case 'm': case 'M': unit *= 1024;	/* Fall through */
+	case 'k': case 'K': unit *= 1024; end++; break;
+	}
+	if (*end != '\0' || size == 0 || size > ULONG_MAX / unit)
+		error (FATAL, "-%s: Invalid memory size", option);
+
+	Option.sortMemory = size * unit;
+}
+
 static void processPatternLengthLimit(const char *const option, const char *const parameter)
 {
 	if (parameter == NULL || parameter[0] == '\0')
@@ -2801,6 +2929,7 @@ static void setBooleanToXtagWithWarning(booleanOption *const option, bool value)
 static void processDumpOptionsOption (const char *const option, const char *const parameter);
 
 static parametricOption ParametricOptions [] = {
+	{ "cache-dir",              processCacheDirOption,          true,   STAGE_ANY },
 	{ "etags-include",          processEtagsInclude,            false,  STAGE_ANY },
 	{ "exclude",                processExcludeOption,           false,  STAGE_ANY },
 	{ "exclude-exception",      processExcludeExceptionOption,  false,  STAGE_ANY },
@@ -2817,6 +2946,7 @@ static parametricOption ParametricOptions [] = {
 	{ "input-encoding",         processInputEncodingOption,     false,  STAGE_ANY },
 	{ "output-encoding",        processOutputEncodingOption,    false,  STAGE_ANY },
 #endif
+	{ "jobs",                   processJobsOption,              true,   STAGE_ANY },
 	{ "lang",                   processLanguageForceOption,     false,  STAGE_ANY },
 	{ "language",               processLanguageForceOption,     false,  STAGE_ANY },
 	{ "language-force",         processLanguageForceOption,     false,  STAGE_ANY },
@@ -2849,6 +2979,7 @@ static parametricOption ParametricOptions [] = {
 	{ "pattern-length-limit",   processPatternLengthLimit,      true,   STAGE_ANY },
 	{ "pseudo-tags",            processPseudoTags,              false,  STAGE_ANY },
 	{ "sort",                   processSortOption,              true,   STAGE_ANY },
+	{ "sort-memory",            processSortMemoryOption,        true,   STAGE_ANY },
 	{ "tag-relative",           processTagRelative,             true,   STAGE_ANY },
 	{ "totals",                 processTotals,                  true,   STAGE_ANY },
 	{ "version",                processVersionOption,           true,   STAGE_ANY },
@@ -2864,6 +2995,7 @@ static parametricOption ParametricOptions [] = {
 	{ "_list-kinddef-flags",     processListKinddefFlagsOptions, true,   STAGE_ANY },
 	{ "_list-langdef-flags",     processListLangdefFlagsOptions, true,   STAGE_ANY },
 	{ "_list-mtable-regex-flags", processListMultitableRegexFlagsOptions, true, STAGE_ANY },
+	{ "_server",                processServerOption,            true,   STAGE_ANY },
 #ifdef DO_TRACING
 	{ "_trace",                 processTraceOption,             false,  STAGE_ANY },
 #endif
@@ -2876,6 +3008,7 @@ static booleanOption BooleanOptions [] = {
 	{ "file-tags",      ((bool *)XTAG_FILE_NAMES),   false, STAGE_ANY, setBooleanToXtagWithWarning },
 	{ "filter",         &Option.filter,                 true,  STAGE_ANY },
 	{ "guess-language-eagerly", &Option.guessLanguageEagerly, false, STAGE_ANY },
+	{ "incremental",    &Option.incremental,            true,  STAGE_ANY },
 	{ "line-directives",&Option.lineDirectives,         false, STAGE_ANY },
 	{ "links",          &Option.followLinks,            false, STAGE_ANY },
 	{ "machinable",     &localOption.machinable,             true,  STAGE_ANY },
@@ -2885,6 +3018,8 @@ static booleanOption BooleanOptions [] = {
 #ifdef RECURSE_SUPPORTED
 	{ "recurse",        &Option.recurse,                false, STAGE_ANY },
 #endif
+	{ "sort-in-memory", &Option.sortInMemory,           true,  STAGE_ANY },
+	{ "tag-index",      &Option.tagIndex,               true,  STAGE_ANY },
 	{ "verbose",        &ctags_verbose,                false, STAGE_ANY },
 #ifdef WIN32
 	{ "use-slash-as-filename-separator", (bool *)&Option.useSlashAsFilenameSeparator, false, STAGE_ANY },
@@ -3259,6 +3394,51 @@ static bool processMultitableExtendingOption (const char *const option,
 	return true;
 }
 
+static void addOptionToFingerprint (const char *const prefix,
+									const char *const option, const char *const parameter)
+{
+	if (prefix [1] == '-')
+	{
+		for (unsigned int i = 0; i < ARRAY_SIZE (OptionsNotFingerprinted); i++)
+			if (strcmp (option, OptionsNotFingerprinted [i]) == 0)
+				return;
+	}
+	else if (strchr ("VRfoL", *option))
+		return;
+
+	if (OptionsFingerprint == NULL)
+		OptionsFingerprint = vStringNew ();
+	vStringCatS (OptionsFingerprint, prefix);
+	vStringCatS (OptionsFingerprint, option);
+	if (parameter && parameter [0] != '\0')
+	{
+		vStringPut (OptionsFingerprint, '=');
+		vStringCatS (OptionsFingerprint, parameter);
+	}
+	vStringPut (OptionsFingerprint, '\n');
+}
+
+/* Return the options processed so far, except the ones not changing the
+ * tags made from an input file. */
+extern const char *getOptionsFingerprint (void)
+{
+	return OptionsFingerprint? vStringValue (OptionsFingerprint): "";
+}
+
+/* A hash of the options in the fingerprint and of the build of ctags.
+ * The tags made from an input file can be reused while it stays the
+ * same. */
+extern unsigned long long getOptionsHash (void)
+{
+	const char *const fingerprint = getOptionsFingerprint ();
+	unsigned long long hash = FNV_OFFSET_BASIS;
+
+	hash = hashBytes (hash, PROGRAM_VERSION, strlen (PROGRAM_VERSION) + 1);
+	if (ctags_repoinfo)
+		hash = hashBytes (hash, ctags_repoinfo, strlen (ctags_repoinfo) + 1);
+	return hashBytes (hash, fingerprint, strlen (fingerprint));
+}
+
 static void processLongOption (
 		const char *const option, const char *const parameter)
 {
@@ -3269,6 +3449,7 @@ static void processLongOption (
 		verbose ("  Option: --%s\n", option);
 	else
 		verbose ("  Option: --%s=%s\n", option, parameter);
+	addOptionToFingerprint ("--", option, parameter);
 
 	if (processBooleanOption (option, parameter))
 		;
@@ -3329,6 +3510,7 @@ static void processShortOption (
 		verbose ("  Option: -%s\n", option);
 	else
 		verbose ("  Option: -%s %s\n", option, parameter);
+	addOptionToFingerprint ("-", option, parameter);
 
 	if (isCompoundOption (*option) && (parameter == NULL  ||  parameter [0] == '\0'))
 		error (FATAL, "Missing parameter for \"%s\" option", option);
@@ -3886,12 +4068,17 @@ extern void freeOptionResources (void)
 
 	freeList (&Excluded);
 	freeList (&ExcludedException);
+	freeGlobSet (&ExcludedSet);
+	freeGlobSet (&ExcludedExceptionSet);
 	freeList (&Option.headerExt);
 	freeList (&Option.etagsInclude);
 
 	freeSearchPathList (&OptlibPathList);
 
 	freeList (&OptionFiles);
+	freeString (&Option.cacheDir);
+	vStringDelete (OptionsFingerprint);
+	OptionsFingerprint = NULL;
 }
 
 static void processDumpOptionsOption (const char *const option CTAGS_ATTR_UNUSED, const char *const parameter CTAGS_ATTR_UNUSED)
@@ -88,6 +88,7 @@ typedef enum eOptionLoadingStage {
  */
 typedef struct sOptionValues {
 	bool append;         /* -a  append to "tags" file */
+	bool incremental;    /* --incremental  reparse changed files only */
 	bool backward;       /* -B  regexp patterns search backwards */
 	bool etags;          /* -e  output Emacs style tags file */
 	exCmd locate;           /* --excmd  EX command used to locate tag */
@@ -118,9 +119,15 @@ typedef struct sOptionValues {
 	unsigned int patternLengthLimit; /* --pattern-length-limit=N */
 	bool putFieldPrefix;		 /* --put-field-prefix */
 	unsigned int maxRecursionDepth; /* --maxdepth=<max-recursion-depth> */
+	unsigned int jobs;	/* --jobs=N */
+	unsigned long sortMemory;	/* --sort-memory=SIZE */
+	bool sortInMemory;	/* --sort-in-memory */
+	char *cacheDir;	/* --cache-dir=DIR */
+	bool tagIndex;	/* --tag-index */
 	enum interactiveMode { INTERACTIVE_NONE = 0,
 						   INTERACTIVE_DEFAULT,
 						   INTERACTIVE_SANDBOX, } interactive; /* --interactive */
+	bool server;	/* --_server */
 #ifdef WIN32
 	enum filenameSepOp { FILENAME_SEP_NO_REPLACE = false,
 						 FILENAME_SEP_USE_SLASH  = true,
@@ -162,6 +169,8 @@ extern void cArgForth (cookedArgs* const current);
 extern bool isExcludedFile (const char* const name,
 							bool falseIfExceptionsAreDefeind);
 extern bool isIncludeFile (const char *const fileName);
+extern const char *getOptionsFingerprint (void);
+extern unsigned long long getOptionsHash (void);
 extern void parseCmdlineOptions (cookedArgs* const cargs);
 extern void previewFirstOption (cookedArgs* const cargs);
 extern void readOptionConfiguration (void);
@@ -18,12 +18,15 @@
 #include "options_p.h"
 
 #include <string.h>
+#include <fnmatch.h>
 
+#include "cache_p.h"
 #include "ctags.h"
 #include "debug.h"
 #include "entry_p.h"
 #include "field_p.h"
 #include "flags_p.h"
+#include "globset_p.h"
 #include "htable.h"
 #include "keyword.h"
 #include "lxpath_p.h"
@@ -105,6 +108,26 @@ typedef struct sParserObject {
 
 } parserObject;
 
+/* The language maps (currentPatterns and currentExtensions) of all parsers
+ * are indexed for finding the parsers for a file name without trying the
+ * patterns and the extensions one by one. The index is built when a file
+ * name is looked up first after a language map is changed. */
+typedef struct sLangMapEntry {
+	langType lang;
+	const vString *spec;		/* an item of currentPatterns or currentExtensions */
+	unsigned int order;			/* the position of spec in the list */
+	globType globType;
+	char *glob;					/* spec without the wildcard of a prefix or a suffix */
+	size_t globLength;
+	struct sLangMapEntry *next;	/* the next entry for the same key */
+} langMapEntry;
+
+typedef struct sLangMapIndex {
+	hashTable *extensions;		/* extension -> langMapEntry list ordered by lang */
+	hashTable *names;			/* file name -> langMapEntry list ordered by lang */
+	ptrArray *globs;			/* langMapEntry ordered by lang and order */
+} langMapIndex;
+
 /*
  * FUNCTION PROTOTYPES
  */
@@ -151,6 +174,9 @@ static parserDefinitionFunc* BuiltInParsers[] = {
 static parserObject* LanguageTable = NULL;
 static unsigned int LanguageCount = 0;
 static hashTable* LanguageHTable = NULL;
+static langMapIndex* LanguageMapIndex = NULL;
+static void (* DeferredPseudoTagsFunc) (langType, void *) = NULL;
+static void *DeferredPseudoTagsData = NULL;
 static kindDefinition defaultFileKind = {
 	.enabled     = false,
 	.letter      = KIND_FILE_DEFAULT_LETTER,
@@ -459,62 +485,227 @@ extern langType getLanguageForCommand (const char *const command, langType start
 											&tmp_specType);
 }
 
-static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
-					   const char **const spec, enum specType *specType)
+static langMapEntry *newLangMapEntry (langType lang, const vString *spec, unsigned int order)
 {
-	langType result = LANG_IGNORE;
-	unsigned int i;
+	langMapEntry *entry = xMalloc (1, langMapEntry);
 
-	if (start_index == LANG_AUTO)
-	        start_index = 0;
-	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
-		return result;
+	entry->lang = lang;
+	entry->spec = spec;
+	entry->order = order;
+	entry->globType = GLOB_NAME;
+	entry->glob = NULL;
+	entry->globLength = 0;
+	entry->next = NULL;
+	return entry;
+}
 
-	*spec = NULL;
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+static void deleteLangMapEntry (langMapEntry *entry)
+{
+	if (entry->glob)
+		eFree (entry->glob);
+	eFree (entry);
+}
+
+static void deleteLangMapEntryList (langMapEntry *entry)
+{
+	while (entry)
 	{
-		parserObject *parser = LanguageTable + i;
-		stringList* const ptrns = parser->currentPatterns;
-		vString* tmp;
+		langMapEntry *next = entry->next;
+		deleteLangMapEntry (entry);
+		entry = next;
+	}
+}
 
-		/* isLanguageEnabled is not used here.
-		   It calls initializeParser which takes
-		   cost. */
-		if (! parser->def->enabled)
-			continue;
+/* Append ENTRY to the list for KEY. Only the first entry for a parser
+ * is kept; it is the one a parser finds first in its list. */
+static void putLangMapEntry (hashTable *table, const char *key, langMapEntry *entry)
+{
+	langMapEntry *last = hashTableGetItem (table, key);
+
+	if (last == NULL)
+	{
+		hashTablePutItem (table, (void *)key, entry);
+		return;
+	}
+
+	while (last->lang != entry->lang && last->next)
+		last = last->next;
+	if (last->lang == entry->lang)
+		deleteLangMapEntry (entry);
+	else
+		last->next = entry;
+}
+
+static void compileLangMapGlob (langMapEntry *entry)
+{
+	const char *const pattern = vStringValue (entry->spec);
+	size_t offset, len;
+
+	entry->globType = globClassify (pattern, &offset, &len);
+	if (entry->globType != GLOB_NAME)
+	{
+		entry->glob = globNewFoldedKey (pattern + offset, len);
+		entry->globLength = len;
+	}
+}
+
+static bool langMapGlobMatched (const langMapEntry *entry, const char *name, size_t len)
+{
+	switch (entry->globType)
+	{
+	case GLOB_PREFIX:
+		return strncmp (name, entry->glob, entry->globLength) == 0;
+	case GLOB_SUFFIX:
+		return (len >= entry->globLength
+				&& strcmp (name + len - entry->globLength, entry->glob) == 0);
+	case GLOB_FNMATCH:
+		return fnmatch (entry->glob, name, 0) == 0;
+	default:
+		AssertNotReached ();
+		return false;
+	}
+}
+
+static hashTable *newLangMapTable (void)
+{
+#ifdef CASE_INSENSITIVE_FILENAMES
+	return hashTableNew (512, hashCstrcasehash, hashCstrcaseeq,
+						 NULL, (hashTableFreeFunc)deleteLangMapEntryList);
+#else
+	return hashTableNew (512, hashCstrhash, hashCstreq,
+						 NULL, (hashTableFreeFunc)deleteLangMapEntryList);
+#endif
+}
+
+static langMapIndex *buildLanguageMapIndex (void)
+{
+	langMapIndex *index = xMalloc (1, langMapIndex);
+
+	index->extensions = newLangMapTable ();
+	index->names = newLangMapTable ();
+	index->globs = ptrArrayNew ((ptrArrayDeleteFunc)deleteLangMapEntry);
+
+	for (unsigned int i = 0; i < LanguageCount; i++)
+	{
+		const parserObject *const parser = LanguageTable + i;
+		const stringList *const ptrns = parser->currentPatterns;
+		const stringList *const exts = parser->currentExtensions;
 
-		if (ptrns != NULL && (tmp = stringListFileFinds (ptrns, baseName)))
+		for (unsigned int j = 0; ptrns && j < stringListCount (ptrns); j++)
 		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_PATTERN;
-			goto found;
+			const vString *ptrn = stringListItem (ptrns, j);
+			langMapEntry *entry = newLangMapEntry (i, ptrn, j);
+
+			compileLangMapGlob (entry);
+			if (entry->globType == GLOB_NAME)
+				putLangMapEntry (index->names, vStringValue (ptrn), entry);
+			else
+				ptrArrayAdd (index->globs, entry);
+		}
+
+		for (unsigned int j = 0; exts && j < stringListCount (exts); j++)
+		{
+			const vString *ext = stringListItem (exts, j);
+			putLangMapEntry (index->extensions, vStringValue (ext),
+							 newLangMapEntry (i, ext, j));
 		}
 	}
+	return index;
+}
 
-	for (i = start_index  ;  i < LanguageCount  &&  result == LANG_IGNORE  ;  ++i)
+static void invalidateLanguageMapIndex (void)
+{
+	if (LanguageMapIndex == NULL)
+		return;
+
+	hashTableDelete (LanguageMapIndex->extensions);
+	hashTableDelete (LanguageMapIndex->names);
+	ptrArrayDelete (LanguageMapIndex->globs);
+	eFree (LanguageMapIndex);
+	LanguageMapIndex = NULL;
+}
+
+static langMapIndex *getLanguageMapIndex (void)
+{
+	if (LanguageMapIndex == NULL)
+		LanguageMapIndex = buildLanguageMapIndex ();
+	return LanguageMapIndex;
+}
+
+static const langMapEntry *findLangMapEntry (const langMapEntry *entry, langType start_index)
+{
+	/* isLanguageEnabled is not used here.
+	   It calls initializeParser which takes
+	   cost. */
+	for (; entry; entry = entry->next)
+		if (entry->lang >= start_index && LanguageTable [entry->lang].def->enabled)
+			return entry;
+	return NULL;
+}
+
+static const langMapEntry *findLangMapGlob (ptrArray *globs, const char *const baseName,
+											langType start_index, const langMapEntry *found)
+{
+	const char *name;
+	size_t len;
+
+	if (ptrArrayCount (globs) == 0)
+		return found;
+
+	name = globFoldName (baseName);
+	len = strlen (name);
+
+	for (unsigned int i = 0; i < ptrArrayCount (globs); i++)
 	{
-		parserObject *parser = LanguageTable + i;
-		stringList* const exts = parser->currentExtensions;
-		vString* tmp;
+		const langMapEntry *entry = ptrArrayItem (globs, i);
 
-		/* isLanguageEnabled is not used here.
-		   It calls initializeParser which takes
-		   cost. */
-		if (! parser->def->enabled)
+		if (entry->lang < start_index || ! LanguageTable [entry->lang].def->enabled)
 			continue;
+		/* Nothing can be found before FOUND any more. */
+		if (found && (entry->lang > found->lang
+					  || (entry->lang == found->lang && entry->order > found->order)))
+			break;
+		if (langMapGlobMatched (entry, name, len))
+			return entry;
+	}
+	return found;
+}
 
-		if (exts != NULL && (tmp = stringListExtensionFinds (exts,
-								     fileExtension (baseName))))
-		{
-			result = i;
-			*spec = vStringValue(tmp);
-			*specType = SPEC_EXTENSION;
-			goto found;
-		}
+static langType getPatternLanguageAndSpec (const char *const baseName, langType start_index,
+					   const char **const spec, enum specType *specType)
+{
+	langMapIndex *index;
+	const langMapEntry *found;
+
+	if (start_index == LANG_AUTO)
+	        start_index = 0;
+	else if (start_index == LANG_IGNORE || start_index >= (int) LanguageCount)
+		return LANG_IGNORE;
+
+	*spec = NULL;
+	index = getLanguageMapIndex ();
+
+	/* A parser having a pattern matching the file name is preferred to
+	 * one having the extension of the file name. */
+	found = findLangMapEntry (hashTableGetItem (index->names, baseName), start_index);
+	found = findLangMapGlob (index->globs, baseName, start_index, found);
+	if (found)
+	{
+		*spec = vStringValue (found->spec);
+		*specType = SPEC_PATTERN;
+		return found->lang;
 	}
-found:
-	return result;
+
+	found = findLangMapEntry (hashTableGetItem (index->extensions,
+												fileExtension (baseName)),
+							  start_index);
+	if (found)
+	{
+		*spec = vStringValue (found->spec);
+		*specType = SPEC_EXTENSION;
+		return found->lang;
+	}
+	return LANG_IGNORE;
 }
 
 extern langType getLanguageForFilename (const char *const filename, langType startFrom)
@@ -941,7 +1132,8 @@ static vString* extractVimFileType(MIO* input)
 	vString* filetype = NULL;
 #define RING_SIZE 5
 	vString* ring[RING_SIZE];
-	int i, j;
+	vString* line = vStringNew ();
+	int i, j, n, count;
 	unsigned int k;
 	const char* const prefix[] = {
 		"vim:", "vi:", "ex:"
@@ -950,20 +1142,27 @@ static vString* extractVimFileType(MIO* input)
 	for (i = 0; i < RING_SIZE; i++)
 		ring[i] = vStringNew ();
 
+	/* A line is read into LINE, not into the ring; reading at EOF
+	   clears the buffer given. */
 	i = 0;
-	while ((readLineRaw (ring[i++], input)) != NULL)
-		if (i == RING_SIZE)
+	count = 0;
+	while ((readLineRaw (line, input)) != NULL)
+	{
+		vString *tmp = ring[i];
+		ring[i] = line;
+		line = tmp;
+		count++;
+		if (++i == RING_SIZE)
 			i = 0;
+	}
+	vStringDelete (line);
 
-	j = i;
-	do
+	/* Look at the last lines from the bottom. */
+	for (n = 0; n < count && n < RING_SIZE && (!filetype); n++)
 	{
 		const char* p;
 
-		j--;
-		if (j < 0)
-			j = RING_SIZE - 1;
-
+		j = (i + RING_SIZE - 1 - n) % RING_SIZE;
 		for (k = 0; k < ARRAY_SIZE(prefix); k++)
 			if ((p = strstr (vStringValue (ring[j]), prefix[k])) != NULL)
 			{
@@ -973,7 +1172,7 @@ static vString* extractVimFileType(MIO* input)
 				filetype = determineVimFileType(p);
 				break;
 			}
-	} while (((i == RING_SIZE)? (j != RING_SIZE - 1): (j != i)) && (!filetype));
+	}
 
 	for (i = RING_SIZE - 1; i >= 0; i--)
 		vStringDelete (ring[i]);
@@ -1041,10 +1240,29 @@ static vString* extractPHPMark(MIO* input)
 }
 
 
+/* The eager tasters don't read the whole input file. They look at a
+ * window at the head or the tail of the input instead. The windows are
+ * read from the input once and shared by the tasters. */
+#define TASTER_WINDOW_SIZE 8192
+
+enum tasterWindowType {
+	TASTER_WINDOW_HEAD,			/* the first bytes of the input */
+	TASTER_WINDOW_TAIL,			/* the last bytes of the input */
+	TASTER_WINDOW_LAST_LINES,	/* the complete lines in the tail window */
+	COUNT_TASTER_WINDOW,
+};
+
+struct tasterWindow {
+	MIO *mio;
+	long start;					/* offset of the window in the input */
+};
+
 struct getLangCtx {
     const char *fileName;
     MIO        *input;
     bool     err;
+    bool     windowsFilled;
+    struct tasterWindow windows [COUNT_TASTER_WINDOW];
 };
 
 #define GLC_FOPEN_IF_NECESSARY0(_glc_, _label_) do {        \
@@ -1084,30 +1302,37 @@ struct getLangCtx {
 static const struct taster {
 	vString* (* taste) (MIO *);
         const char     *msg;
+	enum tasterWindowType window;
 } eager_tasters[] = {
         {
 		.taste  = extractInterpreter,
 		.msg    = "interpreter",
+		.window = TASTER_WINDOW_HEAD,
         },
 	{
 		.taste  = extractZshAutoloadTag,
 		.msg    = "zsh autoload tag",
+		.window = TASTER_WINDOW_HEAD,
 	},
         {
 		.taste  = extractEmacsModeAtFirstLine,
 		.msg    = "emacs mode at the first line",
+		.window = TASTER_WINDOW_HEAD,
         },
         {
 		.taste  = extractEmacsModeLanguageAtEOF,
 		.msg    = "emacs mode at the EOF",
+		.window = TASTER_WINDOW_TAIL,
         },
         {
 		.taste  = extractVimFileType,
 		.msg    = "vim modeline",
+		.window = TASTER_WINDOW_LAST_LINES,
         },
 		{
 		.taste  = extractPHPMark,
 		.msg    = "PHP marker",
+		.window = TASTER_WINDOW_HEAD,
 		}
 };
 static langType tasteLanguage (struct getLangCtx *glc, const struct taster *const tasters, int n_tasters,
@@ -1333,6 +1558,68 @@ static langType getPatternLanguage (const char *const baseName,
 				     fallback);
 }
 
+static void fillTasterWindows (struct getLangCtx *glc)
+{
+	struct tasterWindow *const head = glc->windows + TASTER_WINDOW_HEAD;
+	struct tasterWindow *const tail = glc->windows + TASTER_WINDOW_TAIL;
+	struct tasterWindow *const lines = glc->windows + TASTER_WINDOW_LAST_LINES;
+	unsigned char *data;
+	size_t size;
+	long inputSize;
+
+	if (glc->windowsFilled)
+		return;
+	glc->windowsFilled = true;
+
+	if (mio_seek (glc->input, 0, SEEK_END) != 0)
+		return;
+	inputSize = mio_tell (glc->input);
+	if (inputSize <= 0)
+		return;
+
+	head->start = 0;
+	head->mio = mio_new_mio (glc->input, 0,
+							 inputSize < TASTER_WINDOW_SIZE? inputSize: TASTER_WINDOW_SIZE);
+	if (inputSize <= TASTER_WINDOW_SIZE)
+	{
+		tail->start = 0;
+		tail->mio = head->mio? mio_ref (head->mio): NULL;
+	}
+	else
+	{
+		tail->start = inputSize - TASTER_WINDOW_SIZE;
+		tail->mio = mio_new_mio (glc->input, tail->start, TASTER_WINDOW_SIZE);
+	}
+	if (tail->mio == NULL)
+		return;
+
+	/* Drop the partial line at the start of the tail window. */
+	data = mio_memory_get_data (tail->mio, &size);
+	lines->start = tail->start;
+	if (tail->start == 0)
+		lines->mio = mio_ref (tail->mio);
+	else
+	{
+		const unsigned char *nl = memchr (data, '\n', size);
+		size_t offset = nl? (size_t) (nl - data) + 1: size;
+
+		lines->start += offset;
+		lines->mio = mio_new_memory (data + offset, size - offset, NULL, NULL);
+	}
+}
+
+static void closeTasterWindows (struct getLangCtx *glc)
+{
+	/* The window for the last lines refers to the data of the tail window. */
+	for (int i = COUNT_TASTER_WINDOW - 1; i >= 0; i--)
+	{
+		if (glc->windows [i].mio)
+			mio_unref (glc->windows [i].mio);
+		glc->windows [i].mio = NULL;
+	}
+	glc->windowsFilled = false;
+}
+
 /* This function tries to figure out language contained in a file by
  * running a series of tests, trying to find some clues in the file.
  */
@@ -1344,14 +1631,23 @@ tasteLanguage (struct getLangCtx *glc, const struct taster *const tasters, int n
 
     if (fallback)
 	    *fallback = LANG_IGNORE;
+
+    fillTasterWindows (glc);
     for (i = 0; i < n_tasters; ++i) {
         langType language;
         vString* spec;
+        struct tasterWindow *window = glc->windows + tasters[i].window;
 
-        mio_rewind(glc->input);
-	spec = tasters[i].taste(glc->input);
+        if (window->mio == NULL)
+            continue;
+
+        mio_rewind(window->mio);
+	spec = tasters[i].taste(window->mio);
 
         if (NULL != spec) {
+            /* A selector reads the input from where the taster stopped. */
+            mio_seek (glc->input, window->start + mio_tell (window->mio), SEEK_SET);
+
             verbose ("	%s: %s\n", tasters[i].msg, vStringValue (spec));
             language = getSpecLanguage (vStringValue (spec), glc,
 					(fallback && (*fallback == LANG_IGNORE))? fallback: NULL);
@@ -1467,6 +1763,7 @@ getFileLanguageForRequestInternal (struct GetLanguageRequest *req)
   cleanup:
 	if (req->type == GLR_OPEN && glc.input)
 		req->mio = mio_ref (glc.input);
+    closeTasterWindows (&glc);
     GLC_FCLOSE(&glc);
     if (fstatus)
 	    eStatFree (fstatus);
@@ -1562,6 +1859,7 @@ extern void installLanguageMapDefault (const langType language)
 	parserObject* parser;
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	parser = LanguageTable + language;
+	invalidateLanguageMapIndex ();
 	if (parser->currentPatterns != NULL)
 		stringListDelete (parser->currentPatterns);
 	if (parser->currentExtensions != NULL)
@@ -1636,6 +1934,7 @@ extern void installLanguageAliasesDefaults (void)
 extern void clearLanguageMap (const langType language)
 {
 	Assert (0 <= language  &&  language < (int) LanguageCount);
+	invalidateLanguageMapIndex ();
 	stringListClear ((LanguageTable + language)->currentPatterns);
 	stringListClear ((LanguageTable + language)->currentExtensions);
 }
@@ -1656,6 +1955,7 @@ static bool removeLanguagePatternMap1(const langType language, const char *const
 
 	if (ptrn != NULL && stringListDeleteItemExtension (ptrn, pattern))
 	{
+		invalidateLanguageMapIndex ();
 		verbose (" (removed from %s)", getLanguageName (language));
 		result = true;
 	}
@@ -1686,6 +1986,7 @@ extern void addLanguagePatternMap (const langType language, const char* ptrn,
 	parser = LanguageTable + language;
 	if (exclusiveInAllLanguages)
 		removeLanguagePatternMap (LANG_AUTO, ptrn);
+	invalidateLanguageMapIndex ();
 	stringListAdd (parser->currentPatterns, str);
 }
 
@@ -1696,6 +1997,7 @@ static bool removeLanguageExtensionMap1 (const langType language, const char *co
 
 	if (exts != NULL  &&  stringListDeleteItemExtension (exts, extension))
 	{
+		invalidateLanguageMapIndex ();
 		verbose (" (removed from %s)", getLanguageName (language));
 		result = true;
 	}
@@ -1725,6 +2027,7 @@ extern void addLanguageExtensionMap (
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 	if (exclusiveInAllLanguages)
 		removeLanguageExtensionMap (LANG_AUTO, extension);
+	invalidateLanguageMapIndex ();
 	stringListAdd ((LanguageTable + language)->currentExtensions, str);
 }
 
@@ -1954,6 +2257,8 @@ extern void initializeParsing (void)
 extern void freeParserResources (void)
 {
 	unsigned int i;
+
+	invalidateLanguageMapIndex ();
 	for (i = 0  ;  i < LanguageCount  ;  ++i)
 	{
 		parserObject* const parser = LanguageTable + i;
@@ -2212,6 +2517,7 @@ extern void processLanguageDefineOption (
 	initializeParsingCommon (def, false);
 	linkDependenciesAtInitializeParsing (def);
 
+	invalidateLanguageMapIndex ();
 	LanguageTable [def->id].currentPatterns = stringListNew ();
 	LanguageTable [def->id].currentExtensions = stringListNew ();
 	LanguageTable [def->id].pretendingAsLanguage = LANG_IGNORE;
@@ -3811,10 +4117,9 @@ extern void printParserStatisticsIfUsed (langType language)
 	}
 }
 
-static bool createTagsWithFallback1 (const langType language,
+static void createTagsWithFallback1 (const langType language,
 									 langType *exclusive_subparser)
 {
-	bool tagFileResized = false;
 	unsigned long numTags	= numTagsAdded ();
 	MIOPos tagfpos;
 	int lastPromise = getLastPromise ();
@@ -3834,6 +4139,7 @@ static bool createTagsWithFallback1 (const langType language,
 	if (useCork)
 		corkTagFile(corkFlags);
 
+	beginTagFilePass ();
 	addParserPseudoTags (language);
 	initializeParserStats (parser);
 	tagFilePosition (&tagfpos);
@@ -3853,12 +4159,12 @@ static bool createTagsWithFallback1 (const langType language,
 
 		if (whyRescan == RESCAN_FAILED)
 		{
-			/*  Restore prior state of tag file.
+			/*  Restore prior state of tag file. Only the buffer of
+			 *  the pass is rewound.
 			*/
 			setTagFilePosition (&tagfpos);
 			setNumTagsAdded (numTags);
 			writerRescanFailed (numTags);
-			tagFileResized = true;
 			breakPromisesAfter(lastPromise);
 		}
 		else if (whyRescan == RESCAN_APPEND)
@@ -3883,17 +4189,15 @@ static bool createTagsWithFallback1 (const langType language,
 			*exclusive_subparser = getSubparserLanguage (s);
 	}
 
-	return tagFileResized;
+	commitTagFilePass ();
 }
 
-extern bool runParserInNarrowedInputStream (const langType language,
+extern void runParserInNarrowedInputStream (const langType language,
 					       unsigned long startLine, long startCharOffset,
 					       unsigned long endLine, long endCharOffset,
 					       unsigned long sourceLineOffset,
 					       int promise)
 {
-	bool tagFileResized;
-
 	verbose ("runParserInNarrowedInputStream: %s; "
 			 "file: %s, "
 			 "start(line: %lu, offset: %ld, srcline: %lu)"
@@ -3909,31 +4213,27 @@ extern bool runParserInNarrowedInputStream (const langType language,
 				 endLine, endCharOffset,
 				 sourceLineOffset,
 				 promise);
-	tagFileResized = createTagsWithFallback1 (language, NULL);
+	createTagsWithFallback1 (language, NULL);
 	popNarrowedInputStream  ();
-	return tagFileResized;
-
 }
 
-static bool createTagsWithFallback (
+static void createTagsWithFallback (
 	const char *const fileName, const langType language,
 	MIO *mio, bool *failureInOpenning)
 {
 	langType exclusive_subparser = LANG_IGNORE;
-	bool tagFileResized = false;
 
 	Assert (0 <= language  &&  language < (int) LanguageCount);
 
 	if (!openInputFile (fileName, language, mio))
 	{
 		*failureInOpenning = true;
-		return false;
+		return;
 	}
 	*failureInOpenning = false;
 
-	tagFileResized = createTagsWithFallback1 (language,
-											  &exclusive_subparser);
-	tagFileResized = forcePromises()? true: tagFileResized;
+	createTagsWithFallback1 (language, &exclusive_subparser);
+	forcePromises ();
 
 	pushLanguage ((exclusive_subparser == LANG_IGNORE)
 				  ? language
@@ -3941,8 +4241,6 @@ static bool createTagsWithFallback (
 	makeFileTag (fileName);
 	popLanguage ();
 	closeInputFile ();
-
-	return tagFileResized;
 }
 
 static void printGuessedParser (const char* const fileName, langType language)
@@ -4031,6 +4329,14 @@ static void addParserPseudoTags (langType language)
 	parserObject *parser = LanguageTable + language;
 	if (!parser->pseudoTagPrinted)
 	{
+		/* The pseudo tags are not marked as printed here. Whoever defers
+		 * them decides, with makeDeferredParserPseudoTags(). */
+		if (DeferredPseudoTagsFunc)
+		{
+			DeferredPseudoTagsFunc (language, DeferredPseudoTagsData);
+			return;
+		}
+
 		for (int i = 0; i < PTAG_COUNT; i++)
 		{
 			if (isPtagParserSpecific (i))
@@ -4040,6 +4346,35 @@ static void addParserPseudoTags (langType language)
 	}
 }
 
+extern bool isParserPseudoTagPrinted (const langType language)
+{
+	Assert (0 <= language  &&  language < (int) LanguageCount);
+	return LanguageTable [language].pseudoTagPrinted;
+}
+
+/* While a function is set here, the parser specific pseudo tags are not
+ * written to the tag file. Instead the function is notified of the
+ * language for which they would have been written. The caller emits them
+ * later with makeDeferredParserPseudoTags(). */
+extern void deferParserPseudoTags (void (* func) (langType, void *), void *data)
+{
+	DeferredPseudoTagsFunc = func;
+	DeferredPseudoTagsData = data;
+}
+
+/* Get the function and the data set with deferParserPseudoTags(). */
+extern void getParserPseudoTagsDeferral (void (** func) (langType, void *), void **data)
+{
+	*func = DeferredPseudoTagsFunc;
+	*data = DeferredPseudoTagsData;
+}
+
+extern void makeDeferredParserPseudoTags (langType language)
+{
+	initializeParser (language);
+	addParserPseudoTags (language);
+}
+
 extern bool doesParserRequireMemoryStream (const langType language)
 {
 	Assert (0 <= language  &&  language < (int) LanguageCount);
@@ -4073,18 +4408,16 @@ extern bool doesParserRequireMemoryStream (const langType language)
 	return false;
 }
 
-extern bool parseFile (const char *const fileName)
+extern void parseFile (const char *const fileName)
 {
 	TRACE_ENTER_TEXT("Parsing file %s",fileName);
-	bool bRet = parseFileWithMio (fileName, NULL, NULL);
+	parseFileWithMio (fileName, NULL, NULL);
 	TRACE_LEAVE();
-	return bRet;
 }
 
-static bool parseMio (const char *const fileName, langType language, MIO* mio, bool useSourceFileTagPath,
+static void parseMio (const char *const fileName, langType language, MIO* mio, bool useSourceFileTagPath,
 					  void *clientData)
 {
-	bool tagFileResized = false;
 	bool failureInOpenning = false;
 
 	setupWriter (clientData);
@@ -4093,22 +4426,21 @@ static bool parseMio (const char *const fileName, langType language, MIO* mio, b
 
 	initParserTrashBox ();
 
-	tagFileResized = createTagsWithFallback (fileName, language, mio, &failureInOpenning);
+	createTagsWithFallback (fileName, language, mio, &failureInOpenning);
 
 	finiParserTrashBox ();
 
 	teardownAnon ();
 
 	if (useSourceFileTagPath && (!failureInOpenning))
-		return teardownWriter (getSourceFileTagPath())? true: tagFileResized;
+		teardownWriter (getSourceFileTagPath());
 	else
-		return teardownWriter(fileName);
+		teardownWriter(fileName);
 }
 
-extern bool parseFileWithMio (const char *const fileName, MIO *mio,
+extern void parseFileWithMio (const char *const fileName, MIO *mio,
 							  void *clientData)
 {
-	bool tagFileResized = false;
 	langType language;
 	struct GetLanguageRequest req = {
 		.type = mio? GLR_REUSE: GLR_OPEN,
@@ -4122,7 +4454,9 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 	if (Option.printLanguage)
 	{
 		printGuessedParser (fileName, language);
-		return tagFileResized;
+		if (req.type == GLR_OPEN && req.mio)
+			mio_unref (req.mio);
+		return;
 	}
 
 	if (language == LANG_IGNORE)
@@ -4139,9 +4473,24 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 		/* TODO: checkUTF8BOM can be used to update the encodings. */
 		openConverter (getLanguageEncoding (language), Option.outputEncoding);
 #endif
-		tagFileResized = parseMio (fileName, language, req.mio, true, clientData);
+		parseCache *cache = (req.type == GLR_OPEN)
+			? openParseCache (fileName, language, req.mio)
+			: NULL;
+		if (cache && replayParseCache (cache))
+			;
+		else if (cache)
+		{
+			captureParseCache (cache);
+			parseMio (fileName, language, req.mio, true, clientData);
+			storeParseCache (cache);
+		}
+		else
+			parseMio (fileName, language, req.mio, true, clientData);
+		if (cache)
+			closeParseCache (cache);
+
 		if (Option.filter && ! Option.interactive)
-			closeTagFile (tagFileResized);
+			closeTagFile ();
 		addTotals (1, 0L, 0L);
 
 #ifdef HAVE_ICONV
@@ -4151,25 +4500,20 @@ extern bool parseFileWithMio (const char *const fileName, MIO *mio,
 
 	if (req.type == GLR_OPEN && req.mio)
 		mio_unref (req.mio);
-
-	return tagFileResized;
 }
 
-extern bool parseRawBuffer(const char *fileName, unsigned char *buffer,
+extern void parseRawBuffer(const char *fileName, unsigned char *buffer,
 			 size_t bufferSize, const langType language, void *clientData)
 {
 	MIO *mio = NULL;
-	bool r;
 
 	if (buffer)
 		mio = mio_new_memory (buffer, bufferSize, NULL, NULL);
 
-	r = parseMio (fileName, language, mio, false, clientData);
+	parseMio (fileName, language, mio, false, clientData);
 
 	if (buffer)
 		mio_unref (mio);
-
-	return r;
 }
 
 static void matchLanguageMultilineRegexCommon (const langType language,
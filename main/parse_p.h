@@ -121,12 +121,16 @@ extern void printLanguageSubparsers (const langType language,
 extern void printLangdefFlags (bool withListHeader, bool machinable, FILE *fp);
 extern void printKinddefFlags (bool withListHeader, bool machinable, FILE *fp);
 extern bool doesParserRequireMemoryStream (const langType language);
-extern bool parseFile (const char *const fileName);
-extern bool parseFileWithMio (const char *const fileName, MIO *mio, void *clientData);
-extern bool parseRawBuffer(const char *fileName, unsigned char *buffer,
+extern void deferParserPseudoTags (void (* func) (langType, void *), void *data);
+extern void getParserPseudoTagsDeferral (void (** func) (langType, void *), void **data);
+extern void makeDeferredParserPseudoTags (langType language);
+extern bool isParserPseudoTagPrinted (const langType language);
+extern void parseFile (const char *const fileName);
+extern void parseFileWithMio (const char *const fileName, MIO *mio, void *clientData);
+extern void parseRawBuffer(const char *fileName, unsigned char *buffer,
 			    size_t bufferSize, const langType language, void *clientData);
 
-extern bool runParserInNarrowedInputStream (const langType language,
+extern void runParserInNarrowedInputStream (const langType language,
 					       unsigned long startLine, long startCharOffset,
 					       unsigned long endLine, long endCharOffset,
 					       unsigned long sourceLineOffset,
@@ -155,30 +155,26 @@ void breakPromisesAfter (int promise)
 	promise_count = promise;
 }
 
-bool forcePromises (void)
+void forcePromises (void)
 {
 	int i;
-	bool tagFileResized = false;
 
 	for (i = 0; i < promise_count; ++i)
 	{
 		current_promise = i;
 		struct promise *p = promises + i;
-		tagFileResized = runParserInNarrowedInputStream (p->lang,
-								 p->startLine,
-								 p->startCharOffset,
-								 p->endLine,
-								 p->endCharOffset,
-								 p->sourceLineOffset,
-								 i)
-			? true
-			: tagFileResized;
+		runParserInNarrowedInputStream (p->lang,
+										p->startLine,
+										p->startCharOffset,
+										p->endLine,
+										p->endCharOffset,
+										p->sourceLineOffset,
+										i);
 	}
 
 	freeModifiers (0);
 	current_promise  = NO_PROMISE;
 	promise_count = 0;
-	return tagFileResized;
 }
 
 
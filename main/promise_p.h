@@ -14,7 +14,7 @@
 
 #include "general.h"
 
-bool forcePromises (void);
+void forcePromises (void);
 void breakPromisesAfter (int promise);
 int getLastPromise (void);
 void runModifiers (int promise,
@@ -14,6 +14,7 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+#include <limits.h>
 #include <ctype.h>
 #include <stdlib.h>
 
@@ -390,6 +391,23 @@ static void setOwnerDirectoryOfInputFile (const char *const fileName)
 	}
 }
 
+/* Return the path of FILENAME written to the tag file. */
+extern vString *makeInputFileTagPath (const char *const fileName)
+{
+	if (0)
+		;
+	else if (  Option.tagRelative == TREL_ALWAYS )
+		return vStringNewOwn (relativeFilename (fileName,
+							  getTagFileDirectory ()));
+	else if ( Option.tagRelative == TREL_NEVER )
+		return vStringNewOwn (absoluteFilename (fileName));
+	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (fileName) )
+		return vStringNewInit (fileName);
+	else
+		return vStringNewOwn (relativeFilename (fileName,
+							  getTagFileDirectory ()));
+}
+
 static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const fileName,
 					  const langType language,
 					  stringList *holder)
@@ -406,21 +424,7 @@ static void setInputFileParametersCommon (inputFileInfo *finfo, vString *const f
 			vStringDelete (finfo->tagPath);
 	}
 
-	if (0)
-		;
-	else if (  Option.tagRelative == TREL_ALWAYS )
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
-	else if ( Option.tagRelative == TREL_NEVER )
-		finfo->tagPath =
-			vStringNewOwn (absoluteFilename (vStringValue (fileName)));
-	else if ( Option.tagRelative == TREL_NO || isAbsolutePath (vStringValue (fileName)) )
-		finfo->tagPath = vStringNewCopy (fileName);
-	else
-		finfo->tagPath =
-			vStringNewOwn (relativeFilename (vStringValue (fileName),
-							 getTagFileDirectory ()));
+	finfo->tagPath = makeInputFileTagPath (vStringValue (fileName));
 
 	finfo->isHeader = isIncludeFile (vStringValue (fileName));
 }
@@ -615,6 +619,17 @@ extern MIO *getMio (const char *const fileName, const char *const openMode,
 	st = eStat (fileName);
 	size = st->size;
 	eStatFree (st);
+
+	/* Mapping needs no copy, and pages shared with other processes
+	 * reading the same file. If it is not available, read small files
+	 * into memory, and large ones through stdio. */
+	if (size > 0)
+	{
+		MIO *mio = mio_new_mapped_file (fileName);
+		if (mio)
+			return mio;
+	}
+
 	if ((!memStreamRequired)
 	    && (size > MAX_IN_MEMORY_FILE_SIZE || size == 0))
 		return mio_new_file (fileName, openMode);
@@ -826,6 +841,36 @@ typedef enum eEolType {
 	eol_cr_nl,
 } eolType;
 
+/* Copy a line of a memory stream at once. Return false if the line
+ * must be read with mio_gets(). */
+static bool readLineInMemory (vString *const vLine, MIO *const mio, eolType *r)
+{
+	const char *line;
+	size_t length;
+
+	line = (const char *) mio_memory_gets (mio, &length);
+	if (line == NULL)
+		return false;
+
+	/* strlen() in vStringSetLength() cuts the line at '\0' in readLine(). */
+	if (memchr (line, '\0', length) != NULL)
+	{
+		mio_seek (mio, - (long) length, SEEK_CUR);
+		return false;
+	}
+
+	vStringNCatSUnsafe (vLine, line, length);
+	if (length > 1 && line [length - 1] == '\n' && line [length - 2] == '\r')
+	{
+		vStringChar (vLine, length - 2) = '\n';
+		vStringChop (vLine);
+		*r = eol_cr_nl;
+	}
+	else
+		*r = mio_eof (mio)? eol_eof: eol_nl;
+	return true;
+}
+
 static eolType readLine (vString *const vLine, MIO *const mio)
 {
 	char *str;
@@ -834,6 +879,9 @@ static eolType readLine (vString *const vLine, MIO *const mio)
 
 	vStringClear (vLine);
 
+	if (readLineInMemory (vLine, mio, &r))
+		return r;
+
 	str = vStringValue (vLine);
 	size = vStringSize (vLine);
 
@@ -972,6 +1020,13 @@ extern int getNthPrevCFromInputFile (unsigned int nth, int def)
 extern int skipToCharacterInInputFile (int c)
 {
 	int d;
+
+	if (c > 0 && c <= UCHAR_MAX)
+	{
+		const char chars [2] = { (char) c, '\0' };
+		return skipToCharactersInInputFile (chars, NULL);
+	}
+
 	do
 	{
 		d = getcFromInputFile ();
@@ -992,6 +1047,60 @@ extern int skipToCharacterInInputFile2 (int c0, int c1)
 	return d;
 }
 
+/*  Skips characters in the input file till one of the characters in
+ *  "chars", and returns it, or EOF. This works like calling
+ *  getcFromInputFile () repeatedly, but searches each line at once.
+ *  Unless "skipped" is NULL, the skipped characters are appended to it.
+ */
+extern int skipToCharactersInInputFile (const char *const chars, vString *const skipped)
+{
+	while (File.ungetchIdx > 0)
+	{
+		int c = getcFromInputFile ();
+
+		if (c == EOF || (c > 0 && c <= UCHAR_MAX && strchr (chars, c)))
+			return c;
+		if (skipped)
+			vStringPut (skipped, c);
+	}
+
+	while (true)
+	{
+		const char *s;
+		const char *p;
+
+		if (File.currentLine == NULL)
+		{
+			vString* const line = iFileGetLine ();
+			if (line == NULL)
+				return EOF;
+			File.currentLine = (unsigned char*) vStringValue (line);
+		}
+
+		s = (const char *) File.currentLine;
+		if (chars [0] != '\0' && chars [1] == '\0')
+		{
+			p = strchr (s, chars [0]);
+			if (p == NULL)
+				p = s + strlen (s);
+		}
+		else
+			p = s + strcspn (s, chars);
+
+		if (skipped)
+			vStringNCatSUnsafe (skipped, s, p - s);
+		if (*p == '\0')
+		{
+			File.currentLine = NULL;
+			continue;
+		}
+
+		File.currentLine = (const unsigned char*) p + 1;
+		DebugStatement ( debugPutc (DEBUG_READ, *p); )
+		return (unsigned char) *p;
+	}
+}
+
 /*  An alternative interface to getcFromInputFile (). Do not mix use of readLineFromInputFile()
  *  and getcFromInputFile() for the same file. The returned string does not contain
  *  the terminating newline. A NULL return value means that all lines in the
@@ -1051,6 +1160,50 @@ extern char *readLineFromBypass (
 	return result;
 }
 
+/*  Returns the line referenced by "location" and "lineNumber" in the
+ *  memory-resident input file, without reading it again through the
+ *  input stream. The returned line is not terminated with '\0'; its
+ *  length including the line break is stored in *length. Returns NULL if
+ *  the line cannot be taken so; use readLineFromBypass then.
+ */
+extern const char *getInputLineFromBypass (MIOPos location, unsigned long lineNumber,
+										   size_t *const length)
+{
+	const unsigned char *data;
+	const unsigned char *line;
+	const unsigned char *eol;
+	compoundPos *cpos;
+	size_t size;
+
+#ifdef HAVE_ICONV
+	if (isConverting ())
+		return NULL;
+#endif
+	/* In a narrowed input stream, the map is for the outer stream. */
+	if (BackupFile.mio != NULL)
+		return NULL;
+	if (lineNumber == 0 || lineNumber > File.lineFposMap.count)
+		return NULL;
+
+	cpos = File.lineFposMap.pos + (lineNumber - 1);
+	if (memcmp (&cpos->pos, &location, sizeof (MIOPos)) != 0)
+		return NULL;
+
+	data = mio_memory_get_data (File.mio, &size);
+	if (data == NULL || cpos->offset < 0 || (size_t) cpos->offset >= size)
+		return NULL;
+
+	/* The line must end with a line break and have no '\0' to be the
+	 * same as the one readLineRaw() reads. */
+	line = data + cpos->offset;
+	eol = memchr (line, '\n', size - cpos->offset);
+	if (eol == NULL || memchr (line, '\0', eol - line) != NULL)
+		return NULL;
+
+	*length = eol - line + 1;
+	return (const char *) line;
+}
+
 extern void   pushNarrowedInputStream (
 				       unsigned long startLine, long startCharOffset,
 				       unsigned long endLine, long endCharOffset,
@@ -72,6 +72,7 @@ extern int getcFromInputFile (void);
 extern int getNthPrevCFromInputFile (unsigned int nth, int def);
 extern int skipToCharacterInInputFile (int c);
 extern int skipToCharacterInInputFile2 (int c0, int c1);
+extern int skipToCharactersInInputFile (const char *const chars, vString *const skipped);
 extern void ungetcToInputFile (int c);
 extern const unsigned char *readLineFromInputFile (void);
 
@@ -33,6 +33,7 @@ enum nestedInputBoundaryFlag {
 
 extern const char *getInputLanguageName (void);
 extern const char *getInputFileTagPath (void);
+extern vString *makeInputFileTagPath (const char *const fileName);
 
 extern long getInputFileOffsetForLine (unsigned int line);
 
@@ -66,6 +67,8 @@ extern langType getSourceLanguage (void);
 
 /* Bypass: reading from fp in inputFile WITHOUT updating fields in input fields */
 extern char *readLineFromBypass (vString *const vLine, MIOPos location, long *const pSeekValue);
+extern const char *getInputLineFromBypass (MIOPos location, unsigned long lineNumber,
+										   size_t *const length);
 extern void   pushNarrowedInputStream (
 				       unsigned long startLine, long startCharOffset,
 				       unsigned long endLine, long endCharOffset,
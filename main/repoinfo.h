@@ -0,0 +1 @@
+#define CTAGS_REPOINFO "7c38943"
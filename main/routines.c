@@ -431,6 +431,25 @@ extern bool strToInt(const char *const str, int base, int *value)
 	return true;
 }
 
+/*
+ *  Hashing
+ */
+
+/* FNV-1a. Start with FNV_OFFSET_BASIS, and pass the returned hash to
+ * the next call to hash data given in pieces. */
+extern unsigned long long hashBytes (unsigned long long hash,
+									 const void *bytes, size_t size)
+{
+	const unsigned char *p = bytes;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= p [i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
 /*
  * File system functions
  */
@@ -477,6 +496,7 @@ extern fileStatus *eStat (const char *const fileName)
 				file.isSetuid = (bool) ((status.st_mode & S_ISUID) != 0);
 				file.isSetgid = (bool) ((status.st_mode & S_ISGID) != 0);
 				file.size = status.st_size;
+				file.mtime = status.st_mtime;
 			}
 		}
 	}
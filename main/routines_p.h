@@ -27,6 +27,8 @@
 # endif
 #endif
 
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+
 #if defined (MSDOS_STYLE_PATH)
 # define OUTPUT_PATH_SEPARATOR	'/'
 #else
@@ -68,6 +70,9 @@ typedef struct {
 
 		/* Size of file (pointed to) */
 	unsigned long size;
+
+		/* Last modification time of file (pointed to) */
+	time_t mtime;
 } fileStatus;
 
 /*
@@ -80,6 +85,8 @@ extern void setExecutableName (const char *const path);
 extern const char *getExecutableName (void);
 extern const char *getExecutablePath (void);
 extern void setCurrentDirectory (void);
+extern unsigned long long hashBytes (unsigned long long hash,
+									 const void *bytes, size_t size);
 extern fileStatus *eStat (const char *const fileName);
 extern void eStatFree (fileStatus *status);
 extern bool doesFileExist (const char *const fileName);
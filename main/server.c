@@ -0,0 +1,301 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains the main loop of the server mode (--_server).
+*
+*   The server processes the options and initializes all parsers once,
+*   and then serves requests read from stdin, or from each connection to
+*   a Unix domain socket. A request is a line:
+*
+*     file NAME          make tags for the input file NAME
+*     buffer SIZE NAME   make tags for the SIZE bytes following the line,
+*                        as the contents of an input file NAME; SIZE is
+*                        up to SERVER_BUFFER_SIZE_MAX
+*     quit               end the session
+*
+*   The tags for a request are written in the output format, followed by
+*   a line "!_SERVER_DONE<TAB>NAME". A request which cannot be served is
+*   answered with a line "!_SERVER_ERROR<TAB>MESSAGE". A client may send
+*   a batch of requests without waiting for the answers.
+*
+*   Each connection to the socket is served by a process forked from the
+*   server. Thus connections are served concurrently, and each of them
+*   starts with the parsers initialized.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#if defined (HAVE_UNISTD_H)
+# include <unistd.h>
+#endif
+#if defined (HAVE_SYS_WAIT_H)
+# include <sys/wait.h>
+#endif
+#if defined (HAVE_SYS_SOCKET_H)
+# include <sys/socket.h>
+#endif
+#if defined (HAVE_SYS_UN_H)
+# include <sys/un.h>
+#endif
+#if defined (HAVE_SYS_STAT_H)
+# include <sys/stat.h>
+#endif
+
+#include "debug.h"
+#include "mio.h"
+#include "options_p.h"
+#include "parse_p.h"
+#include "read.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "server_p.h"
+#include "vstring.h"
+
+#if defined (HAVE_SOCKET) && defined (HAVE_SYS_SOCKET_H) && defined (HAVE_SYS_UN_H) \
+	&& defined (HAVE_FORK) && defined (HAVE_WAITPID) && defined (HAVE_SYS_WAIT_H)
+# define SERVER_SOCKET_SUPPORTED
+#endif
+
+/*
+*   MACROS
+*/
+#define SERVER_DONE "!_SERVER_DONE"
+#define SERVER_ERROR "!_SERVER_ERROR"
+
+/* The largest buffer a request may send */
+#define SERVER_BUFFER_SIZE_MAX (256UL * 1024 * 1024)
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern bool isServerSocketSupported (void)
+{
+#ifdef SERVER_SOCKET_SUPPORTED
+	return true;
+#else
+	return false;
+#endif
+}
+
+static void respond (const char *const status, const char *const detail)
+{
+	printf ("%s\t%s\n", status, detail);
+	fflush (stdout);
+}
+
+static void serveFile (const char *const fileName)
+{
+	fileStatus *status = eStat (fileName);
+	const char *problem = NULL;
+
+	if (! status->exists)
+		problem = "no such input file";
+	else if (status->isDirectory)
+		problem = "input file is a directory";
+	eStatFree (status);
+	if (problem)
+	{
+		respond (SERVER_ERROR, problem);
+		return;
+	}
+
+	parseFile (fileName);
+	respond (SERVER_DONE, fileName);
+}
+
+/* Return false if the rest of the session cannot be read. */
+static bool serveBuffer (MIO *const in, const char *const request)
+{
+	char *fileName;
+	unsigned long size = strtoul (request, &fileName, 10);
+	unsigned char *data;
+	MIO *mio;
+
+	if (fileName == request || *fileName != ' ' || fileName [1] == '\0')
+	{
+		respond (SERVER_ERROR, "broken buffer request");
+		return false;
+	}
+	fileName++;
+
+	/* The body of the request cannot be skipped reliably. */
+	if (size > SERVER_BUFFER_SIZE_MAX)
+	{
+		respond (SERVER_ERROR, "too large buffer");
+		return false;
+	}
+
+	data = eMalloc (size + 1);
+	if (mio_read (in, data, 1, size) != size)
+	{
+		eFree (data);
+		respond (SERVER_ERROR, "unexpected end of buffer");
+		return false;
+	}
+
+	mio = mio_new_memory (data, size, eRealloc, eFreeNoNullCheck);
+	parseFileWithMio (fileName, mio, NULL);
+	mio_unref (mio);
+	respond (SERVER_DONE, fileName);
+	return true;
+}
+
+static void serveSession (FILE *const fp)
+{
+	MIO *in = mio_new_fp (fp, NULL);
+	vString *request = vStringNew ();
+
+	while (readLineRaw (request, in) != NULL)
+	{
+		const char *r;
+
+		vStringStripNewline (request);
+		if (vStringLength (request) > 0 && vStringLast (request) == '\r')
+			vStringChop (request);
+		r = vStringValue (request);
+
+		if (*r == '\0')
+			continue;
+		else if (strcmp (r, "quit") == 0)
+			break;
+		else if (strncmp (r, "file ", 5) == 0)
+			serveFile (r + 5);
+		else if (strncmp (r, "buffer ", 7) == 0)
+		{
+			if (! serveBuffer (in, r + 7))
+				break;
+		}
+		else
+			respond (SERVER_ERROR, "unknown request");
+	}
+
+	vStringDelete (request);
+	mio_unref (in);
+}
+
+#ifdef SERVER_SOCKET_SUPPORTED
+static int openServerSocket (const char *const socketName)
+{
+	struct sockaddr_un addr;
+	struct stat st;
+	int fd;
+
+	if (strlen (socketName) >= sizeof (addr.sun_path))
+		error (FATAL, "too long socket name: %s", socketName);
+
+	memset (&addr, 0, sizeof (addr));
+	addr.sun_family = AF_UNIX;
+	strcpy (addr.sun_path, socketName);
+
+	fd = socket (AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		error (FATAL | PERROR, "cannot make socket");
+
+	/* A socket left by a server gone can be reused: nobody accepts a
+	 * connection to it. */
+	if (lstat (socketName, &st) == 0 && S_ISSOCK (st.st_mode))
+	{
+		int probe = socket (AF_UNIX, SOCK_STREAM, 0);
+
+		if (probe < 0)
+			error (FATAL | PERROR, "cannot make socket");
+		if (connect (probe, (struct sockaddr *) &addr, sizeof (addr)) == 0)
+			error (FATAL, "server already running on socket \"%s\"", socketName);
+		if (errno == ECONNREFUSED)
+			remove (socketName);
+		close (probe);
+	}
+
+	/* Only the user running the server may connect to it. */
+	mode_t mask = umask (077);
+	if (bind (fd, (struct sockaddr *) &addr, sizeof (addr)) != 0)
+		error (FATAL | PERROR, "cannot bind socket \"%s\"", socketName);
+	umask (mask);
+	if (listen (fd, SOMAXCONN) != 0)
+		error (FATAL | PERROR, "cannot listen on socket \"%s\"", socketName);
+	return fd;
+}
+
+/* Reap the processes whose sessions are over, also while the server
+ * waits for a connection. */
+static void reapSessions (int signum CTAGS_ATTR_UNUSED)
+{
+	int savedErrno = errno;
+
+	while (waitpid (-1, NULL, WNOHANG) > 0)
+		;
+	errno = savedErrno;
+}
+
+static void serveSocket (const char *const socketName)
+{
+	int fd = openServerSocket (socketName);
+
+	signal (SIGCHLD, reapSessions);
+	verbose ("serving on socket %s\n", socketName);
+	while (true)
+	{
+		int conn = accept (fd, NULL, NULL);
+		pid_t pid;
+
+		if (conn < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			error (FATAL | PERROR, "cannot accept connection");
+		}
+
+		fflush (stdout);
+		pid = fork ();
+		if (pid < 0)
+			error (WARNING | PERROR, "cannot fork a process for the connection");
+		else if (pid == 0)
+		{
+			signal (SIGCHLD, SIG_DFL);
+			close (fd);
+			if (dup2 (conn, STDIN_FILENO) < 0 || dup2 (conn, STDOUT_FILENO) < 0)
+				error (FATAL | PERROR, "cannot redirect the connection");
+			close (conn);
+			clearerr (stdin);
+			serveSession (stdin);
+			fflush (stdout);
+			exit (0);
+		}
+		close (conn);
+	}
+}
+#endif
+
+extern void serverLoop (cookedArgs *args, void *user)
+{
+	struct serverModeArgs *sargs = user;
+
+	if (! cArgOff (args))
+		error (FATAL, "no input file can be given in server mode");
+
+	verbose ("initializing all parsers\n");
+	initializeParser (LANG_AUTO);
+
+	if (sargs->socketName)
+	{
+#ifdef SERVER_SOCKET_SUPPORTED
+		serveSocket (sargs->socketName);
+#else
+		AssertNotReached ();
+#endif
+	}
+	else
+		serveSession (stdin);
+}
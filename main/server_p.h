@@ -0,0 +1,33 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to server.c
+*/
+#ifndef CTAGS_MAIN_SERVER_PRIVATE_H
+#define CTAGS_MAIN_SERVER_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include "options_p.h"
+
+/*
+*   DATA DECLARATIONS
+*/
+struct serverModeArgs
+{
+	char *socketName;	/* NULL for serving stdin */
+};
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern bool isServerSocketSupported (void);
+extern void serverLoop (cookedArgs *args, void *user);
+
+#endif  /* CTAGS_MAIN_SERVER_PRIVATE_H */
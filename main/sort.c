@@ -21,12 +21,15 @@
 #endif
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
 
 #include "debug.h"
 #include "entry_p.h"
 #include "options_p.h"
+#include "ptrarray.h"
 #include "read.h"
 #include "routines.h"
+#include "routines_p.h"
 #include "sort_p.h"
 
 /*
@@ -45,6 +48,153 @@ extern void catFile (MIO *mio)
 	}
 }
 
+extern void failedSort (MIO *const mio, const char* msg)
+{
+	const char* const cannotSort = "cannot sort tag file";
+	if (mio != NULL)
+		mio_unref (mio);
+	if (msg == NULL)
+		error (FATAL | PERROR, "%s", cannotSort);
+	else
+		error (FATAL, "%s: %s", msg, cannotSort);
+}
+
+/* Compare the lines ignoring case. Unlike struppercmp(), characters are
+ * compared as unsigned chars so that the keys of the in-memory sort can
+ * be made from bytes. */
+static int compareFoldedLines (const char *const line1, const char *const line2)
+{
+	const unsigned char *p1 = (const unsigned char *) line1;
+	const unsigned char *p2 = (const unsigned char *) line2;
+	int r;
+
+	while ((r = toupper (*p1) - toupper (*p2)) == 0 && *p1 != '\0')
+	{
+		++p1;
+		++p2;
+	}
+	return r;
+}
+
+static int compareLines (const char *const line1, const char *const line2)
+{
+	if (Option.sorted == SO_FOLDSORTED)
+	{
+		/* Order lines differing only in case consistently; the merge
+		 * relies on a total order to drop identical lines. */
+		const int r = compareFoldedLines (line1, line2);
+		return r != 0 ? r : strcmp (line1, line2);
+	}
+	return strcmp (line1, line2);
+}
+
+static void writeSortedLine (MIO *const mio, const char *const line)
+{
+	if (mio_puts (mio, line) == EOF || mio_putc (mio, '\n') == EOF)
+		failedSort (mio, NULL);
+}
+
+/*
+ *  These functions sort the tags kept in memory (--sort-in-memory). The
+ *  lines are terminated in place, and sorted through pointers to them;
+ *  they are neither copied nor read again. The first bytes of each line
+ *  are packed into an integer key so that most comparisons don't touch
+ *  the lines.
+ */
+
+#define SORT_KEY_BYTES sizeof (unsigned long long)
+
+typedef struct sSortKey {
+	unsigned long long prefix;
+	const char *line;
+} sortKey;
+
+/* Make a key ordering lines as compareLines() does for their first
+ * bytes. */
+static unsigned long long makeSortKeyPrefix (const char *const line)
+{
+	const bool folded = (Option.sorted == SO_FOLDSORTED);
+	unsigned long long prefix = 0;
+	bool terminated = false;
+
+	for (size_t i = 0 ; i < SORT_KEY_BYTES ; ++i)
+	{
+		unsigned char c = 0;
+
+		if (! terminated && line [i] == '\0')
+			terminated = true;
+		if (! terminated)
+			c = folded ? (unsigned char) toupper ((unsigned char) line [i])
+				: (unsigned char) line [i];
+		prefix = (prefix << 8) | c;
+	}
+	return prefix;
+}
+
+static int compareSortKeys (const void *const one, const void *const two)
+{
+	const sortKey *const key1 = one;
+	const sortKey *const key2 = two;
+
+	if (key1->prefix != key2->prefix)
+		return key1->prefix < key2->prefix ? -1 : 1;
+	return compareLines (key1->line, key2->line);
+}
+
+/* Sort the lines in BUFFER, and write them to MIO. BUFFER is modified. */
+extern void sortTagsInMemory (MIO *const mio, char *const buffer, const size_t size)
+{
+	sortKey *keys;
+	char *lastLine = NULL;
+	size_t count = 0;
+	size_t i;
+	char *p;
+
+	for (p = buffer ; p < buffer + size ; ++p)
+		if (*p == '\n')
+			++count;
+	keys = xMalloc (count + 1, sortKey);
+
+	count = 0;
+	for (p = buffer ; p < buffer + size ; )
+	{
+		char *end = memchr (p, '\n', (buffer + size) - p);
+
+		if (end == NULL)
+		{
+			/* There is no room to terminate the last line in place. */
+			lastLine = eStrndup (p, (buffer + size) - p);
+			p = lastLine;
+			end = lastLine + strlen (lastLine);
+		}
+		*end = '\0';
+		if (end > p)  /* ignore blank lines */
+		{
+			keys [count].line = p;
+			keys [count].prefix = makeSortKeyPrefix (p);
+			++count;
+		}
+		if (lastLine)
+			break;
+		p = end + 1;
+	}
+
+	qsort (keys, count, sizeof (*keys), compareSortKeys);
+
+	for (i = 0 ; i < count ; ++i)
+	{
+		/*  Here we filter out identical tag *lines* (including search
+		 *  pattern), as "sort -u" does.
+		 */
+		if (i == 0  ||  strcmp (keys [i].line, keys [i-1].line) != 0)
+			writeSortedLine (mio, keys [i].line);
+	}
+	PrintStatus (("sort memory: %ld bytes\n", (long) (size + count * sizeof (*keys))));
+	eFree (keys);
+	if (lastLine)
+		eFree (lastLine);
+}
+
 #ifdef EXTERNAL_SORT
 
 #ifdef NON_CONST_PUTENV_PROTOTYPE
@@ -158,132 +308,272 @@ extern void externalSortTags (const bool toStdout, MIO *tagFile)
 #else
 
 /*
- *  These functions provide a basic internal sort. No great memory
- *  optimization is performed (e.g. recursive subdivided sorts),
- *  so have lots of memory if you have large tag files.
+ *  These functions provide an internal merge sort working in bounded
+ *  memory. Lines are collected until they occupy --sort-memory bytes,
+ *  sorted, and spilled to a temporary file as a sorted run. The runs are
+ *  merged with a heap at the end. If all lines fit in memory, no run is
+ *  spilled. Identical lines are dropped while writing a run or merging
+ *  the runs, as "sort -u" does, even in an xref file.
  */
 
-extern void failedSort (MIO *const mio, const char* msg)
-{
-	const char* const cannotSort = "cannot sort tag file";
-	if (mio != NULL)
-		mio_unref (mio);
-	if (msg == NULL)
-		error (FATAL | PERROR, "%s", cannotSort);
-	else
-		error (FATAL, "%s: %s", msg, cannotSort);
-}
+/* The maximum number of runs merged at once. If there are more runs,
+ * they are merged into longer runs first. */
+#define SORT_MERGE_WIDTH 64
 
-static int compareTagsFolded(const void *const one, const void *const two)
-{
-	const char *const line1 = *(const char* const*) one;
-	const char *const line2 = *(const char* const*) two;
+/* What a line in the buffer is assumed to cost on top of its characters:
+ * the pointer in the table and the overhead of malloc. */
+#define SORT_LINE_OVERHEAD (sizeof (char *) + 2 * sizeof (size_t))
 
-	return struppercmp (line1, line2);
-}
+typedef struct sSortRun {
+	MIO *mio;
+	char *name;
+} sortRun;
+
+typedef struct sSortBuffer {
+	char **table;
+	size_t count;
+	size_t size;
+	size_t bytes;
+} sortBuffer;
+
+typedef struct sMergeSource {
+	sortRun *run;
+	vString *line;
+} mergeSource;
 
 static int compareTags (const void *const one, const void *const two)
 {
 	const char *const line1 = *(const char* const*) one;
 	const char *const line2 = *(const char* const*) two;
 
-	return strcmp (line1, line2);
+	return compareLines (line1, line2);
 }
 
-static void writeSortedTags (
-		char **const table, const size_t numTags, const bool toStdout, bool newlineReplaced)
+static bool isDuplicatedLine (const char *const line, const vString *const previous)
+{
+	return (previous != NULL
+			&& strcmp (line, vStringValue (previous)) == 0);
+}
+
+/* Write the lines in BUFFER to MIO in order, and empty BUFFER. */
+static void writeSortBuffer (sortBuffer *const buffer, MIO *const mio)
 {
-	MIO *mio;
 	size_t i;
 
-	/*  Write the sorted lines back into the tag file.
-	 */
-	if (toStdout)
-		mio = mio_new_fp (stdout, NULL);
-	else
+	qsort (buffer->table, buffer->count, sizeof (*buffer->table), compareTags);
+	for (i = 0 ; i < buffer->count ; ++i)
 	{
-		mio = mio_new_file (tagFileName (), "w");
-		if (mio == NULL)
-			failedSort (mio, NULL);
+		if (i == 0  ||  strcmp (buffer->table [i], buffer->table [i-1]) != 0)
+			writeSortedLine (mio, buffer->table [i]);
 	}
-	for (i = 0 ; i < numTags ; ++i)
+	for (i = 0 ; i < buffer->count ; ++i)
+		eFree (buffer->table [i]);
+	buffer->count = 0;
+	buffer->bytes = 0;
+}
+
+static sortRun *newSortRun (void)
+{
+	sortRun *run = xMalloc (1, sortRun);
+
+	run->mio = tempFile ("w+b", &run->name);
+	return run;
+}
+
+static void deleteSortRun (void *data)
+{
+	sortRun *run = data;
+
+	mio_unref (run->mio);
+	remove (run->name);
+	eFree (run->name);
+	eFree (run);
+}
+
+static void spillSortBuffer (sortBuffer *const buffer, ptrArray *const runs)
+{
+	sortRun *run = newSortRun ();
+
+	verbose ("sort: spilling a run of %lu lines to %s\n",
+			 (unsigned long) buffer->count, run->name);
+	writeSortBuffer (buffer, run->mio);
+	ptrArrayAdd (runs, run);
+}
+
+static bool readMergeSource (mergeSource *const source)
+{
+	MIO *const mio = source->run->mio;
+
+	if (readLineRaw (source->line, mio) == NULL)
 	{
-		/*  Here we filter out identical tag *lines* (including search
-		 *  pattern) if this is not an xref file.
-		 */
-		if (i == 0  ||  Option.xref  ||  strcmp (table [i], table [i-1]) != 0)
-		{
-			if (mio_puts (mio, table [i]) == EOF)
-				failedSort (mio, NULL);
-			else if (newlineReplaced)
-				mio_putc (mio, '\n');
-		}
+		if (! mio_eof (mio))
+			failedSort (NULL, NULL);
+		return false;
 	}
-	if (toStdout)
-		mio_flush (mio);
-	mio_unref (mio);
+	vStringStripNewline (source->line);
+	return true;
 }
 
-extern void internalSortTags (const bool toStdout, MIO* mio, size_t numTags)
+static bool isSourceBefore (const mergeSource *const a, const mergeSource *const b)
 {
-	vString *vLine = vStringNew ();
-	const char *line;
+	const int r = compareLines (vStringValue (a->line), vStringValue (b->line));
+
+	/* Prefer the earlier run to keep the merge stable. */
+	return r < 0 || (r == 0 && a < b);
+}
+
+static void siftDownMergeHeap (mergeSource **const heap, const size_t count, size_t i)
+{
+	for (;;)
+	{
+		size_t smallest = i;
+		const size_t left = 2 * i + 1;
+		const size_t right = left + 1;
+
+		if (left < count && isSourceBefore (heap [left], heap [smallest]))
+			smallest = left;
+		if (right < count && isSourceBefore (heap [right], heap [smallest]))
+			smallest = right;
+		if (smallest == i)
+			break;
+
+		mergeSource *const tmp = heap [i];
+		heap [i] = heap [smallest];
+		heap [smallest] = tmp;
+		i = smallest;
+	}
+}
+
+/* Merge COUNT runs in RUNS starting from FIRST into MIO. */
+static void mergeSortRuns (ptrArray *const runs, const unsigned int first,
+						   const unsigned int count, MIO *const mio)
+{
+	mergeSource *const sources = xMalloc (count, mergeSource);
+	mergeSource **const heap = xMalloc (count, mergeSource *);
+	vString *previous = vStringNew ();
+	bool written = false;
+	size_t n = 0;
 	size_t i;
-	int (*cmpFunc)(const void *, const void *);
-	bool newlineReplaced = false;
 
-	/*  Allocate a table of line pointers to be sorted.
-	 */
-	const size_t tableSize = numTags * sizeof (char *);
-	char **table = (char **) malloc (tableSize);  /* line pointers */
-	DebugStatement ( size_t mallocSize = tableSize; )  /* cumulative total */
+	for (i = 0 ; i < count ; ++i)
+	{
+		sources [i].run = ptrArrayItem (runs, first + i);
+		sources [i].line = vStringNew ();
+		mio_rewind (sources [i].run->mio);
+		if (readMergeSource (sources + i))
+			heap [n++] = sources + i;
+	}
+	for (i = n ; i > 0 ; --i)
+		siftDownMergeHeap (heap, n, i - 1);
 
+	while (n > 0)
+	{
+		mergeSource *const top = heap [0];
 
-	cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
-	if (table == NULL)
-		failedSort (mio, "out of memory");
+		if (! (written && isDuplicatedLine (vStringValue (top->line), previous)))
+		{
+			writeSortedLine (mio, vStringValue (top->line));
+			vStringCopy (previous, top->line);
+			written = true;
+		}
+		if (! readMergeSource (top))
+			heap [0] = heap [--n];
+		siftDownMergeHeap (heap, n, 0);
+	}
 
-	for (i = 0  ;  i < numTags  &&  ! mio_eof (mio)  ;  )
+	for (i = 0 ; i < count ; ++i)
+		vStringDelete (sources [i].line);
+	vStringDelete (previous);
+	eFree (heap);
+	eFree (sources);
+}
+
+/* Merge the runs in RUNS into fewer, longer runs until they can be merged
+ * at once. */
+static ptrArray *reduceSortRuns (ptrArray *runs)
+{
+	while (ptrArrayCount (runs) > SORT_MERGE_WIDTH)
 	{
-		line = readLineRaw (vLine, mio);
-		if (line == NULL)
+		const unsigned int count = ptrArrayCount (runs);
+		ptrArray *merged = ptrArrayNew (deleteSortRun);
+
+		for (unsigned int first = 0 ; first < count ; first += SORT_MERGE_WIDTH)
 		{
-			if (! mio_eof (mio))
-				failedSort (mio, NULL);
-			break;
+			const unsigned int width = (count - first < SORT_MERGE_WIDTH
+										? count - first : SORT_MERGE_WIDTH);
+			sortRun *run = newSortRun ();
+
+			verbose ("sort: merging %u runs to %s\n", width, run->name);
+			mergeSortRuns (runs, first, width, run->mio);
+			ptrArrayAdd (merged, run);
 		}
-		else if (*line == '\0'  ||  strcmp (line, "\n") == 0)
-			;  /* ignore blank lines */
-		else
+		ptrArrayDelete (runs);
+		runs = merged;
+	}
+	return runs;
+}
+
+extern void internalSortTags (const bool toStdout, MIO* mio)
+{
+	vString *vLine = vStringNew ();
+	ptrArray *runs = ptrArrayNew (deleteSortRun);
+	sortBuffer buffer = { .table = NULL, .count = 0, .size = 0, .bytes = 0 };
+	DebugStatement ( size_t maxBytes = 0; )
+	MIO *output;
+
+	while (readLineRaw (vLine, mio) != NULL)
+	{
+		vStringStripNewline (vLine);
+		if (vStringLength (vLine) == 0)
+			continue;  /* ignore blank lines */
+
+		const size_t bytes = vStringLength (vLine) + 1 + SORT_LINE_OVERHEAD;
+		if (buffer.count > 0 && buffer.bytes + bytes > Option.sortMemory)
+			spillSortBuffer (&buffer, runs);
+
+		if (buffer.count == buffer.size)
 		{
-			const size_t stringSize = strlen (line) + 1;
-
-			table [i] = (char *) malloc (stringSize);
-			if (table [i] == NULL)
-				failedSort (mio, "out of memory");
-			DebugStatement ( mallocSize += stringSize; )
-			strcpy (table [i], line);
-			if (table[i][stringSize - 2] == '\n')
-			{
-				table[i][stringSize - 2] = '\0';
-				newlineReplaced = true;
-			}
-			++i;
+			buffer.size = buffer.size ? buffer.size * 2 : 1024;
+			buffer.table = xRealloc (buffer.table, buffer.size, char *);
 		}
+		buffer.table [buffer.count++] = eStrndup (vStringValue (vLine),
+												  vStringLength (vLine));
+		buffer.bytes += bytes;
+		DebugStatement ( if (buffer.bytes > maxBytes) maxBytes = buffer.bytes; )
 	}
-	numTags = i;
+	if (! mio_eof (mio))
+		failedSort (mio, NULL);
 	vStringDelete (vLine);
 
-	/*  Sort the lines.
+	if (ptrArrayCount (runs) > 0 && buffer.count > 0)
+		spillSortBuffer (&buffer, runs);
+	runs = reduceSortRuns (runs);
+
+	/*  Write the sorted lines back into the tag file.
 	 */
-	qsort (table, numTags, sizeof (*table), cmpFunc);
+	if (toStdout)
+		output = mio_new_fp (stdout, NULL);
+	else
+	{
+		output = mio_new_file (tagFileName (), "w");
+		if (output == NULL)
+			failedSort (output, NULL);
+	}
 
-	writeSortedTags (table, numTags, toStdout, newlineReplaced);
+	if (ptrArrayCount (runs) > 0)
+		mergeSortRuns (runs, 0, ptrArrayCount (runs), output);
+	else
+		writeSortBuffer (&buffer, output);
 
-	PrintStatus (("sort memory: %ld bytes\n", (long) mallocSize));
-	for (i = 0 ; i < numTags ; ++i)
-		free (table [i]);
-	free (table);
+	if (toStdout)
+		mio_flush (output);
+	if (mio_unref (output) != 0)
+		failedSort (NULL, NULL);
+
+	PrintStatus (("sort memory: %ld bytes\n", (long) maxBytes));
+	ptrArrayDelete (runs);
+	if (buffer.table)
+		eFree (buffer.table);
 }
 
 #endif
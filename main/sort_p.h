@@ -22,13 +22,12 @@
 *   FUNCTION PROTOTYPES
 */
 extern void catFile (MIO *mio);
+extern void sortTagsInMemory (MIO *const mio, char *const buffer, const size_t size);
 
 #ifdef EXTERNAL_SORT
 extern void externalSortTags (const bool toStdout, MIO *tagFile);
 #else
-extern void internalSortTags (const bool toStdout,
-			      MIO *mio,
-			      size_t numTags);
+extern void internalSortTags (const bool toStdout, MIO *mio);
 #endif
 
 /* mio is closed in this function. */
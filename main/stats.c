@@ -44,6 +44,13 @@ extern void addTotals (
 	Totals.bytes += bytes;
 }
 
+extern void getTotals (long *files, long *lines, long *bytes)
+{
+	*files = Totals.files;
+	*lines = Totals.lines;
+	*bytes = Totals.bytes;
+}
+
 extern void printTotals (const clock_t *const timeStamps, bool append, sortType sorted)
 {
 	const unsigned long totalTags = numTagsTotal();
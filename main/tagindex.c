@@ -0,0 +1,401 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   This module contains functions for writing the index of a tag file
+*   (--tag-index). readtags uses the index, if it is next to the tag file,
+*   to find tags without searching the tag file.
+*
+*   The index file is named after the tag file with ".idx" appended. All
+*   numbers in it are little endian. It consists of:
+*
+*     header (80 bytes)
+*       "!_TAGIDX"                 magic
+*       uint32 version (2), uint32 reserved
+*       uint64 size of the tag file
+*       uint64 modification time of the tag file (seconds since the epoch)
+*       uint64 number of tags (N)
+*       uint64 number of hash buckets (B, a power of 2)
+*       uint64 position of the sorted array
+*       uint64 position of the folded array
+*       uint64 position of the buckets for the sorted array
+*       uint64 position of the buckets for the folded array
+*     sorted array: N uint64 positions of tag lines in the tag file,
+*       ordered by the names of the tags, compared as unsigned chars
+*       after unescaping, and then by the positions
+*     folded array: the same, ordered by the names folded to upper case
+*     buckets (B entries of uint32 hash, uint32 index + 1, for each array):
+*       an open addressing hash table with linear probing. For each
+*       distinct name, the entry points to the first element of the array
+*       having the name. The hash is 32 bit FNV-1a of the unescaped name
+*       (folded to upper case for the folded array). 0 means an empty entry.
+*
+*   Pseudo tags are not indexed.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "debug.h"
+#include "mio.h"
+#include "options.h"
+#include "routines.h"
+#include "routines_p.h"
+#include "tagindex_p.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define TAG_INDEX_SUFFIX ".idx"
+#define TAG_INDEX_MAGIC "!_TAGIDX"
+#define TAG_INDEX_VERSION 2
+#define TAG_INDEX_HEADER_SIZE 80
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sIndexEntry {
+	const char *name;	/* escaped; terminated by a tab or a newline */
+	unsigned long long offset;
+} indexEntry;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static int xdigitValue (int digit)
+{
+	if (digit >= '0' && digit <= '9')
+		return digit - '0';
+	else if (digit >= 'a' && digit <= 'f')
+		return 10 + digit - 'a';
+	else
+		return 10 + digit - 'A';
+}
+
+/* Read a character of a name, unescaping it as readtags does.
+ * Return -1 at the end of the name. */
+static int readNameCharacter (const char **s)
+{
+	const unsigned char *p = (const unsigned char *) *s;
+	int c = *p++;
+
+	if (c == '\t' || c == '\n' || c == '\r' || c == '\0')
+		return -1;
+
+	if (c == '\\')
+	{
+		switch (*p)
+		{
+			case 't': c = '\t'; p++; break;
+			case 'r': c = '\r'; p++; break;
+			case 'n': c = '\n'; p++; break;
+			case '\\': c = '\\'; p++; break;
+			case 'a': c = '\a'; p++; break;
+			case 'b': c = '\b'; p++; break;
+			case 'v': c = '\v'; p++; break;
+			case 'f': c = '\f'; p++; break;
+			case 'x':
+				if (isxdigit (p [1]) && isxdigit (p [2]))
+				{
+					int val = (xdigitValue (p [1]) << 4) | xdigitValue (p [2]);
+					if (val < 0x80)
+					{
+						p += 3;
+						c = val;
+					}
+				}
+				break;
+		}
+	}
+
+	*s = (const char *) p;
+	return c;
+}
+
+static int compareNames (const char *s1, const char *s2, bool folded)
+{
+	int c1, c2;
+
+	do
+	{
+		c1 = readNameCharacter (&s1);
+		c2 = readNameCharacter (&s2);
+		if (folded)
+		{
+			c1 = c1 < 0 ? c1 : toupper (c1);
+			c2 = c2 < 0 ? c2 : toupper (c2);
+		}
+	} while (c1 == c2 && c1 >= 0);
+	return c1 - c2;
+}
+
+static unsigned int hashName (const char *s, bool folded)
+{
+	unsigned int hash = 2166136261U;
+	int c;
+
+	while ((c = readNameCharacter (&s)) >= 0)
+	{
+		hash ^= (unsigned int) (folded ? toupper (c) : c);
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static int compareEntries (const indexEntry *e1, const indexEntry *e2)
+{
+	int r = compareNames (e1->name, e2->name, false);
+	if (r != 0)
+		return r;
+	return e1->offset < e2->offset ? -1 : (e1->offset > e2->offset);
+}
+
+static int compareEntriesSorted (const void *a, const void *b)
+{
+	return compareEntries (a, b);
+}
+
+static int compareEntriesFolded (const void *a, const void *b)
+{
+	int r = compareNames (((const indexEntry *) a)->name,
+						  ((const indexEntry *) b)->name, true);
+	return r != 0 ? r : compareEntries (a, b);
+}
+
+static void putNumber (unsigned char *buf, unsigned long long n, int size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		buf [i] = (unsigned char) (n & 0xff);
+		n >>= 8;
+	}
+}
+
+static bool writeNumber (MIO *mio, unsigned long long n, int size)
+{
+	unsigned char buf [8];
+
+	putNumber (buf, n, size);
+	return mio_write (mio, buf, 1, size) == (size_t) size;
+}
+
+static bool writeArray (MIO *mio, indexEntry *entries, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		if (! writeNumber (mio, entries [i].offset, 8))
+			return false;
+	return true;
+}
+
+static bool writeBuckets (MIO *mio, indexEntry *entries, size_t count,
+						  size_t bucketCount, bool folded)
+{
+	unsigned char *buckets = xCalloc (bucketCount * 8, unsigned char);
+	bool r;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i > 0 && compareNames (entries [i - 1].name, entries [i].name, folded) == 0)
+			continue;
+
+		unsigned int hash = hashName (entries [i].name, folded);
+		size_t b = hash & (bucketCount - 1);
+		while (buckets [b * 8 + 4] || buckets [b * 8 + 5]
+			   || buckets [b * 8 + 6] || buckets [b * 8 + 7])
+			b = (b + 1) & (bucketCount - 1);
+		putNumber (buckets + b * 8, hash, 4);
+		putNumber (buckets + b * 8 + 4, i + 1, 4);
+	}
+
+	r = (mio_write (mio, buckets, 8, bucketCount) == bucketCount);
+	eFree (buckets);
+	return r;
+}
+
+static size_t countDistinctNames (indexEntry *entries, size_t count)
+{
+	size_t n = 0;
+
+	for (size_t i = 0; i < count; i++)
+		if (i == 0 || compareNames (entries [i - 1].name, entries [i].name, false) != 0)
+			n++;
+	return n;
+}
+
+static indexEntry *collectEntries (const char *data, size_t size, size_t *count)
+{
+	const char *const end = data + size;
+	size_t allocated = 1024;
+	indexEntry *entries = xMalloc (allocated, indexEntry);
+	const char *p = data;
+
+	*count = 0;
+	while (p < end)
+	{
+		const char *eol = memchr (p, '\n', end - p);
+		if (eol == NULL)
+			eol = end;
+
+		/* Skip pseudo tags and lines having an empty name like readtags. */
+		if (! (p [0] == '!' && eol - p > 1 && p [1] == '_')
+			&& p [0] != '\t' && p [0] != '\n' && p [0] != '\r')
+		{
+			if (*count == allocated)
+			{
+				allocated *= 2;
+				entries = xRealloc (entries, allocated, indexEntry);
+			}
+			entries [*count].name = p;
+			entries [*count].offset = p - data;
+			++*count;
+		}
+		p = eol + 1;
+	}
+	return entries;
+}
+
+static bool writeIndex (MIO *mio, indexEntry *entries, size_t count,
+						unsigned long long tagFileSize,
+						unsigned long long tagFileTime)
+{
+	size_t distinct = countDistinctNames (entries, count);
+	size_t bucketCount = 16;
+	unsigned long long sortedPos, foldedPos, bucketsPos, foldedBucketsPos;
+
+	while (bucketCount < 2 * distinct)
+		bucketCount *= 2;
+
+	sortedPos = TAG_INDEX_HEADER_SIZE;
+	foldedPos = sortedPos + 8ULL * count;
+	bucketsPos = foldedPos + 8ULL * count;
+	foldedBucketsPos = bucketsPos + 8ULL * bucketCount;
+
+	if (mio_write (mio, TAG_INDEX_MAGIC, 1, 8) != 8
+		|| ! writeNumber (mio, TAG_INDEX_VERSION, 4)
+		|| ! writeNumber (mio, 0, 4)
+		|| ! writeNumber (mio, tagFileSize, 8)
+		|| ! writeNumber (mio, tagFileTime, 8)
+		|| ! writeNumber (mio, count, 8)
+		|| ! writeNumber (mio, bucketCount, 8)
+		|| ! writeNumber (mio, sortedPos, 8)
+		|| ! writeNumber (mio, foldedPos, 8)
+		|| ! writeNumber (mio, bucketsPos, 8)
+		|| ! writeNumber (mio, foldedBucketsPos, 8))
+		return false;
+
+	if (! writeArray (mio, entries, count))
+		return false;
+
+	indexEntry *folded = xMalloc (count + 1, indexEntry);
+	memcpy (folded, entries, count * sizeof (indexEntry));
+	qsort (folded, count, sizeof (indexEntry), compareEntriesFolded);
+
+	bool r = (writeArray (mio, folded, count)
+			  && writeBuckets (mio, entries, count, bucketCount, false)
+			  && writeBuckets (mio, folded, count, bucketCount, true));
+	eFree (folded);
+	return r;
+}
+
+static unsigned char *loadTagFile (const char *const tagFileName, MIO **mio, size_t *size)
+{
+	unsigned char *data;
+
+	*mio = mio_new_mapped_file (tagFileName);
+	if (*mio)
+		return mio_memory_get_data (*mio, size);
+
+	/* Not mapped; the tag file may be empty. */
+	*mio = mio_new_file (tagFileName, "rb");
+	if (*mio == NULL)
+		return NULL;
+
+	vString *contents = vStringNew ();
+	char buffer [BUFSIZ];
+	size_t n;
+	while ((n = mio_read (*mio, buffer, 1, sizeof (buffer))) > 0)
+		vStringNCatSUnsafe (contents, buffer, n);
+	mio_unref (*mio);
+
+	*size = vStringLength (contents);
+	data = (unsigned char *) vStringDeleteUnwrap (contents);
+	*mio = mio_new_memory (data, *size, eRealloc, eFreeNoNullCheck);
+	return data;
+}
+
+extern void writeTagIndex (const char *const tagFileName)
+{
+	vString *indexName;
+	vString *tempName;
+	indexEntry *entries;
+	size_t count;
+	size_t size;
+	MIO *tagFile;
+	MIO *mio;
+	const char *data;
+	fileStatus *status;
+	unsigned long long mtime;
+	bool failed;
+
+	data = (const char *) loadTagFile (tagFileName, &tagFile, &size);
+	if (data == NULL)
+	{
+		error (WARNING | PERROR, "cannot read tag file \"%s\" to index", tagFileName);
+		return;
+	}
+
+	entries = collectEntries (data, size, &count);
+	if (count >= 0xffffffffUL)
+	{
+		error (WARNING, "too many tags to index in \"%s\"", tagFileName);
+		eFree (entries);
+		mio_unref (tagFile);
+		return;
+	}
+	qsort (entries, count, sizeof (indexEntry), compareEntriesSorted);
+
+	status = eStat (tagFileName);
+	mtime = (unsigned long long) status->mtime;
+	eStatFree (status);
+
+	indexName = vStringNewInit (tagFileName);
+	vStringCatS (indexName, TAG_INDEX_SUFFIX);
+	tempName = vStringNewCopy (indexName);
+	vStringCatS (tempName, ".tmp");
+
+	verbose ("writing tag index %s (%lu tags)\n", vStringValue (indexName),
+			 (unsigned long) count);
+	mio = mio_new_file (vStringValue (tempName), "wb");
+	if (mio == NULL)
+		error (FATAL | PERROR, "cannot open tag index \"%s\"", vStringValue (tempName));
+	failed = ! writeIndex (mio, entries, count, size, mtime);
+	failed = (mio_unref (mio) != 0) || failed;
+
+	if (! failed && rename (vStringValue (tempName), vStringValue (indexName)) != 0)
+	{
+		/* rename() doesn't replace an existing file on some platforms. */
+		remove (vStringValue (indexName));
+		failed = (rename (vStringValue (tempName), vStringValue (indexName)) != 0);
+	}
+	if (failed)
+	{
+		remove (vStringValue (tempName));
+		error (FATAL | PERROR, "cannot write tag index \"%s\"", vStringValue (indexName));
+	}
+
+	vStringDelete (tempName);
+	vStringDelete (indexName);
+	eFree (entries);
+	mio_unref (tagFile);
+}
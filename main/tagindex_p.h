@@ -0,0 +1,22 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   External interface to tagindex.c
+*/
+#ifndef CTAGS_MAIN_TAGINDEX_PRIVATE_H
+#define CTAGS_MAIN_TAGINDEX_PRIVATE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"  /* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void writeTagIndex (const char *const tagFileName);
+
+#endif  /* CTAGS_MAIN_TAGINDEX_PRIVATE_H */
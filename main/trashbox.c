@@ -10,9 +10,14 @@
 
 #include "general.h"
 
+#include "arena_p.h"
 #include "debug.h"
 #include "routines.h"
 #include "trashbox.h"
+#include "trashbox_p.h"
+
+/* The size of the chunks of the parser arena */
+#define PARSER_ARENA_CHUNK_SIZE (64 * 1024)
 
 typedef TrashBoxDestroyItemProc TrashDestroyItemProc;
 typedef struct sTrash {
@@ -23,20 +28,24 @@ typedef struct sTrash {
 
 struct sTrashBox {
 	Trash *trash;
+	Arena *arena;	/* allocating Trash nodes if not NULL */
 };
 
 static TrashBox* defaultTrashBox;
 static TrashBox* parserTrashBox;
+static Arena* parserArena;
 
 static Trash* trashPut (Trash* trash, void* item,
-			TrashDestroyItemProc destrctor);
-static Trash* trashTakeBack (Trash* trash, void* item, TrashDestroyItemProc* destrctor);
-static Trash* trashMakeEmpty (Trash* trash);
+			TrashDestroyItemProc destrctor, Arena *arena);
+static Trash* trashTakeBack (Trash* trash, void* item, TrashDestroyItemProc* destrctor,
+							 Arena *arena);
+static Trash* trashMakeEmpty (Trash* trash, Arena *arena);
 
 extern TrashBox* trashBoxNew (void)
 {
 	TrashBox *t = xMalloc (1, TrashBox);
 	t->trash = NULL;
+	t->arena = NULL;
 	return t;
 }
 
@@ -67,7 +76,7 @@ extern void*  trashBoxPut (TrashBox* trash_box, void* item, TrashBoxDestroyItemP
 	if (!trash_box)
 		trash_box = defaultTrashBox;
 
-	trash_box->trash = trashPut(trash_box->trash, item, destroy);
+	trash_box->trash = trashPut(trash_box->trash, item, destroy, trash_box->arena);
 	return item;
 }
 
@@ -78,7 +87,7 @@ extern TrashBoxDestroyItemProc trashBoxTakeBack (TrashBox* trash_box, void* item
 	if (!trash_box)
 		trash_box = defaultTrashBox;
 
-	trash_box->trash = trashTakeBack(trash_box->trash, item, &d);
+	trash_box->trash = trashTakeBack(trash_box->trash, item, &d, trash_box->arena);
 	return d;
 }
 
@@ -87,7 +96,7 @@ extern void   trashBoxMakeEmpty (TrashBox* trash_box)
 	if (!trash_box)
 		trash_box = defaultTrashBox;
 
-	trash_box->trash = trashMakeEmpty (trash_box->trash);
+	trash_box->trash = trashMakeEmpty (trash_box->trash, trash_box->arena);
 }
 
 
@@ -103,16 +112,16 @@ extern void      trashBoxFree      (TrashBox* trash_box, void* item)
 }
 
 static Trash* trashPut (Trash* trash, void* item,
-			TrashDestroyItemProc destrctor)
+			TrashDestroyItemProc destrctor, Arena *arena)
 {
-	Trash* t = xMalloc (1, Trash);
+	Trash* t = arena? arenaAlloc (arena, sizeof (Trash)): xMalloc (1, Trash);
 	t->next = trash;
 	t->item = item;
 	t->destrctor = destrctor? destrctor: eFree;
 	return t;
 }
 
-static TrashBoxDestroyItemProc trashTakeBack0  (Trash** trash, void* item)
+static TrashBoxDestroyItemProc trashTakeBack0  (Trash** trash, void* item, Arena *arena)
 {
 	TrashBoxDestroyItemProc removed;
 	Trash* tmp;
@@ -128,7 +137,8 @@ static TrashBoxDestroyItemProc trashTakeBack0  (Trash** trash, void* item)
 			tmp->item = NULL;
 			removed = tmp->destrctor;
 
-			eFree (tmp);
+			if (!arena)
+				eFree (tmp);
 			tmp = NULL;
 			break;
 		}
@@ -140,17 +150,18 @@ static TrashBoxDestroyItemProc trashTakeBack0  (Trash** trash, void* item)
 	return removed;
 }
 
-static Trash* trashTakeBack (Trash* trash, void* item, TrashDestroyItemProc *destrctor)
+static Trash* trashTakeBack (Trash* trash, void* item, TrashDestroyItemProc *destrctor,
+							 Arena *arena)
 {
 	TrashDestroyItemProc d;
-	d = trashTakeBack0 (&trash, item);
+	d = trashTakeBack0 (&trash, item, arena);
 	if (destrctor)
 		*destrctor = d;
 
 	return trash;
 }
 
-static Trash* trashMakeEmpty (Trash* trash)
+static Trash* trashMakeEmpty (Trash* trash, Arena *arena)
 {
 	Trash* tmp;
 
@@ -161,7 +172,8 @@ static Trash* trashMakeEmpty (Trash* trash)
 		tmp->destrctor (tmp->item);
 		tmp->item = NULL;
 		tmp->destrctor = NULL;
-		eFree (tmp);
+		if (!arena)
+			eFree (tmp);
 	}
 	return NULL;
 }
@@ -177,15 +189,30 @@ extern void finiDefaultTrashBox (void)
 	defaultTrashBox = NULL;
 }
 
+static void deleteParserArena (void *arena)
+{
+	arenaDelete (arena);
+	parserArena = NULL;
+}
+
 extern void initParserTrashBox (void)
 {
+	/* The arena is kept for the next input files once it is made. */
+	if (parserArena == NULL)
+	{
+		parserArena = arenaNew (PARSER_ARENA_CHUNK_SIZE);
+		DEFAULT_TRASH_BOX (parserArena, deleteParserArena);
+	}
+
 	parserTrashBox = trashBoxNew ();
+	parserTrashBox->arena = parserArena;
 }
 
 extern void finiParserTrashBox  (void)
 {
 	trashBoxDelete (parserTrashBox);
 	parserTrashBox = NULL;
+	arenaReset (parserArena);
 }
 
 extern void* parserTrashBoxPut  (void* item, TrashBoxDestroyItemProc destroy)
@@ -198,6 +225,13 @@ extern TrashBoxDestroyItemProc parserTrashBoxTakeBack  (void* item)
 	return trashBoxTakeBack(parserTrashBox, item);
 }
 
+extern void* parserArenaAlloc (size_t size)
+{
+	if (parserTrashBox == NULL)
+		return NULL;
+	return arenaAlloc (parserArena, size);
+}
+
 #ifdef TRASH_TEST
 #include <stdio.h>
 
@@ -63,4 +63,10 @@ extern void      trashBoxMakeEmpty (TrashBox* trash_box);
 extern void* parserTrashBoxPut  (void* item, TrashBoxDestroyItemProc destroy);
 extern TrashBoxDestroyItemProc parserTrashBoxTakeBack  (void* item);
 
+/* The memory allocated with parserArenaAlloc () is released at once, after
+ * the parser trash box is emptied. Don't free it. Outside of `parser' method,
+ * parserArenaAlloc () returns NULL.
+ */
+extern void* parserArenaAlloc (size_t size);
+
 #endif /* CTAGS_MAIN_TRASH_H */
@@ -305,6 +305,18 @@ extern void vStringCatSWithEscaping (vString* b, const char *s)
 {
 	for(; *s; s++)
 	{
+		/* Copy the run of characters needing no escape at once. */
+		const char *p = s;
+		while (*p && !((*p > 0x00 && *p <= 0x1F) || *p == 0x7F || *p == '\\'))
+			p++;
+		if (p != s)
+		{
+			vStringNCatSUnsafe (b, s, p - s);
+			s = p;
+			if (*s == '\0')
+				break;
+		}
+
 		int c = *s;
 
 		/* escape control characters (incl. \t) */
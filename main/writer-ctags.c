@@ -17,6 +17,7 @@
 #include "parse_p.h"
 #include "ptag_p.h"
 #include "read.h"
+#include "vstring.h"
 #include "writer_p.h"
 #include "xtag.h"
 #include "xtag_p.h"
@@ -36,20 +37,31 @@ static int writeCtagsPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 								void *clientData);
 static bool treatFieldAsFixed (int fieldType);
 static void checkCtagsOptions (tagWriter *writer);
+static void *beginCtagsFile (tagWriter *writer CTAGS_ATTR_UNUSED, MIO * mio CTAGS_ATTR_UNUSED,
+							 void *clientData CTAGS_ATTR_UNUSED);
+static void prepareEnabledFields (void);
 
 #ifdef WIN32
 static enum filenameSepOp overrideFilenameSeparator (enum filenameSepOp currentSetting);
 #endif	/* WIN32 */
 
-struct rejection {
-	bool rejectionInThisInput;
-};
+/* The fields enabled for the current input file. prepareEnabledFields ()
+ * fills this before writing the tags of each input file because options
+ * may be given between input files. */
+static struct enabledFields {
+	bool kind, kindLong, lineNumber, language, scope, typeRef, fileScope;
+	const char *kindKey;		/* "kind:" or "" */
+	const char *scopeKey;		/* "scope:" or "" */
+	/* the fields rendered after the file scope field, in order */
+	fieldType others [8];
+	unsigned int count;
+} enabledFields;
 
 tagWriter uCtagsWriter = {
 	.writeEntry = writeCtagsEntry,
 	.writePtagEntry = writeCtagsPtagEntry,
 	.printPtagByDefault = true,
-	.preWriteEntry = NULL,
+	.preWriteEntry = beginCtagsFile,
 	.postWriteEntry = NULL,
 	.rescanFailedEntry = NULL,
 	.treatFieldAsFixed = treatFieldAsFixed,
@@ -60,21 +72,11 @@ tagWriter uCtagsWriter = {
 	.defaultFileName = CTAGS_FILE,
 };
 
-static void *beginECtagsFile (tagWriter *writer CTAGS_ATTR_UNUSED, MIO * mio CTAGS_ATTR_UNUSED,
-							  void *clientData CTAGS_ATTR_UNUSED)
-{
-	static struct rejection rej;
-
-	rej.rejectionInThisInput = false;
-
-	return &rej;
-}
-
-static bool endECTagsFile (tagWriter *writer, MIO * mio CTAGS_ATTR_UNUSED, const char* filename CTAGS_ATTR_UNUSED,
-						   void *clientData CTAGS_ATTR_UNUSED)
+static void *beginCtagsFile (tagWriter *writer CTAGS_ATTR_UNUSED, MIO * mio CTAGS_ATTR_UNUSED,
+							 void *clientData CTAGS_ATTR_UNUSED)
 {
-	struct rejection *rej = writer->private;
-	return rej->rejectionInThisInput;
+	prepareEnabledFields ();
+	return NULL;
 }
 
 #ifdef WIN32
@@ -90,8 +92,8 @@ tagWriter eCtagsWriter = {
 	.writeEntry = writeCtagsEntry,
 	.writePtagEntry = writeCtagsPtagEntry,
 	.printPtagByDefault = true,
-	.preWriteEntry = beginECtagsFile,
-	.postWriteEntry = endECTagsFile,
+	.preWriteEntry = beginCtagsFile,
+	.postWriteEntry = NULL,
 	.rescanFailedEntry = NULL,
 	.treatFieldAsFixed = treatFieldAsFixed,
 	.defaultFileName = CTAGS_FILE,
@@ -165,41 +167,31 @@ static bool hasTagEntryTabOrNewlineChar (const tagEntryInfo * const tag)
 }
 
 
-static const char* escapeFieldValueFull (tagWriter *writer, const tagEntryInfo * tag, fieldType ftype, int fieldIndex)
+static bool renderFieldValue (tagWriter *writer, const tagEntryInfo * tag, fieldType ftype, int fieldIndex,
+							  vString *line)
 {
-	const char *v;
-	if (writer->type == WRITER_E_CTAGS && doesFieldHaveRenderer(ftype, true))
-		v = renderFieldNoEscaping (ftype, tag, fieldIndex);
-	else
-		v = renderField (ftype, tag, fieldIndex);
+	bool noEscaping = (writer->type == WRITER_E_CTAGS && doesFieldHaveRenderer(ftype, true));
 
-	return v;
+	return renderFieldIntoBuffer (ftype, tag, fieldIndex, noEscaping, line);
 }
 
-static const char* escapeFieldValue (tagWriter *writer, const tagEntryInfo * tag, fieldType ftype)
+static void renderExtensionFieldMaybe (tagWriter *writer, int xftype, const tagEntryInfo *const tag, char sep[2],
+									   vString *line)
 {
-	return escapeFieldValueFull (writer, tag, ftype, NO_PARSER_FIELD);
-}
-
-static int renderExtensionFieldMaybe (tagWriter *writer, int xftype, const tagEntryInfo *const tag, char sep[2], MIO *mio)
-{
-	if (isFieldEnabled (xftype) && doesFieldHaveValue (xftype, tag))
+	if (doesFieldHaveValue (xftype, tag))
 	{
-		int len;
-		len = mio_printf (mio, "%s\t%s:%s", sep,
-				  getFieldName (xftype),
-				  escapeFieldValue (writer, tag, xftype));
+		vStringCatS (line, sep);
+		vStringPut (line, '\t');
+		vStringCatS (line, getFieldName (xftype));
+		vStringPut (line, ':');
+		renderFieldValue (writer, tag, xftype, NO_PARSER_FIELD, line);
 		sep[0] = '\0';
-		return len;
 	}
-	else
-		return 0;
 }
 
-static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
+static void addParserFields (tagWriter *writer, const tagEntryInfo *const tag, vString *line)
 {
 	unsigned int i;
-	int length = 0;
 
 	for (i = 0; i < tag->usedParserFields; i++)
 	{
@@ -208,54 +200,45 @@ static int addParserFields (tagWriter *writer, MIO * mio, const tagEntryInfo *co
 		if (! isFieldEnabled (ftype))
 			continue;
 
-		length += mio_printf(mio, "\t%s:%s",
-							 getFieldName (ftype),
-							 escapeFieldValueFull (writer, tag, ftype, i));
+		vStringPut (line, '\t');
+		vStringCatS (line, getFieldName (ftype));
+		vStringPut (line, ':');
+		renderFieldValue (writer, tag, ftype, i, line);
 	}
-	return length;
 }
 
-static int writeLineNumberEntry (tagWriter *writer, MIO * mio, const tagEntryInfo *const tag)
+static void catNumber (vString *line, const char *fmt, unsigned long n)
+{
+	char buf[32];
+
+	snprintf (buf, sizeof(buf), fmt, n);
+	vStringCatS (line, buf);
+}
+
+static void writeLineNumberEntry (tagWriter *writer, const tagEntryInfo *const tag, vString *line)
 {
 	if (Option.lineDirectives)
-		return mio_printf (mio, "%s", escapeFieldValue (writer, tag, FIELD_LINE_NUMBER));
+		renderFieldValue (writer, tag, FIELD_LINE_NUMBER, NO_PARSER_FIELD, line);
 	else
-		return mio_printf (mio, "%lu", tag->lineNumber);
+		catNumber (line, "%lu", tag->lineNumber);
 }
 
-static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *const tag)
+static void addExtensionFields (tagWriter *writer, const tagEntryInfo *const tag, vString *line)
 {
-	bool isKindKeyEnabled = isFieldEnabled (FIELD_KIND_KEY);
-	bool isScopeEnabled = isFieldEnabled   (FIELD_SCOPE_KEY);
-
-	const char* const kindKey = isKindKeyEnabled
-		?getFieldName (FIELD_KIND_KEY)
-		:"";
-	const char* const kindFmt = isKindKeyEnabled
-		?"%s\t%s:%s"
-		:"%s\t%s%s";
-	const char* const scopeKey = isScopeEnabled
-		?getFieldName (FIELD_SCOPE_KEY)
-		:"";
-	const char* const scopeFmt = isScopeEnabled
-		?"%s\t%s:%s:%s"
-		:"%s\t%s%s:%s";
-
 	char sep [] = {';', '"', '\0'};
-	int length = 0;
 
-	const char *str = NULL;;
+	const char *str = NULL;
 	kindDefinition *kdef = getLanguageKind(tag->langType, tag->kindIndex);
 	const char kind_letter_str[2] = {kdef->letter, '\0'};
 
-	if (kdef->name != NULL && (isFieldEnabled (FIELD_KIND_LONG)  ||
-		 (isFieldEnabled (FIELD_KIND)  && kdef->letter == KIND_NULL_LETTER)))
+	if (kdef->name != NULL && (enabledFields.kindLong  ||
+		 (enabledFields.kind  && kdef->letter == KIND_NULL_LETTER)))
 	{
 		/* Use kind long name */
 		str = kdef->name;
 	}
-	else if (kdef->letter != KIND_NULL_LETTER  && (isFieldEnabled (FIELD_KIND) ||
-			(isFieldEnabled (FIELD_KIND_LONG) &&  kdef->name == NULL)))
+	else if (kdef->letter != KIND_NULL_LETTER  && (enabledFields.kind ||
+			(enabledFields.kindLong &&  kdef->name == NULL)))
 	{
 		/* Use kind letter */
 		str = kind_letter_str;
@@ -263,77 +246,78 @@ static int addExtensionFields (tagWriter *writer, MIO *mio, const tagEntryInfo *
 
 	if (str)
 	{
-		length += mio_printf (mio, kindFmt, sep, kindKey, str);
+		vStringCatS (line, sep);
+		vStringPut (line, '\t');
+		vStringCatS (line, enabledFields.kindKey);
+		vStringCatS (line, str);
 		sep [0] = '\0';
 	}
 
-	if (isFieldEnabled (FIELD_LINE_NUMBER) &&  doesFieldHaveValue (FIELD_LINE_NUMBER, tag))
+	if (enabledFields.lineNumber &&  doesFieldHaveValue (FIELD_LINE_NUMBER, tag))
 	{
-		length += mio_printf (mio, "%s\t%s:%ld", sep,
-				   getFieldName (FIELD_LINE_NUMBER),
-				   tag->lineNumber);
+		vStringCatS (line, sep);
+		vStringPut (line, '\t');
+		vStringCatS (line, getFieldName (FIELD_LINE_NUMBER));
+		catNumber (line, ":%ld", tag->lineNumber);
 		sep [0] = '\0';
 	}
 
-	length += renderExtensionFieldMaybe (writer, FIELD_LANGUAGE, tag, sep, mio);
+	if (enabledFields.language)
+		renderExtensionFieldMaybe (writer, FIELD_LANGUAGE, tag, sep, line);
 
-	if (isFieldEnabled (FIELD_SCOPE))
+	if (enabledFields.scope)
 	{
-		const char* k, *v;
+		size_t length = vStringLength (line);
 
-		k = escapeFieldValue (writer, tag, FIELD_SCOPE_KIND_LONG);
-		v = escapeFieldValue (writer, tag, FIELD_SCOPE);
-		if (k && v)
+		vStringCatS (line, sep);
+		vStringPut (line, '\t');
+		vStringCatS (line, enabledFields.scopeKey);
+		if (renderFieldValue (writer, tag, FIELD_SCOPE_KIND_LONG, NO_PARSER_FIELD, line))
 		{
-			length += mio_printf (mio, scopeFmt, sep, scopeKey, k, v);
-			sep [0] = '\0';
+			vStringPut (line, ':');
+			if (renderFieldValue (writer, tag, FIELD_SCOPE, NO_PARSER_FIELD, line))
+				sep [0] = '\0';
+			else
+				vStringTruncate (line, length);
 		}
+		else
+			vStringTruncate (line, length);
 	}
 
-	if (isFieldEnabled (FIELD_TYPE_REF) && doesFieldHaveValue (FIELD_TYPE_REF, tag))
-	{
-		length += mio_printf (mio, "%s\t%s:%s", sep,
-				      getFieldName (FIELD_TYPE_REF),
-				      escapeFieldValue (writer, tag, FIELD_TYPE_REF));
-		sep [0] = '\0';
-	}
+	if (enabledFields.typeRef)
+		renderExtensionFieldMaybe (writer, FIELD_TYPE_REF, tag, sep, line);
 
-	if (isFieldEnabled (FIELD_FILE_SCOPE) &&  doesFieldHaveValue (FIELD_FILE_SCOPE, tag))
+	if (enabledFields.fileScope &&  doesFieldHaveValue (FIELD_FILE_SCOPE, tag))
 	{
-		length += mio_printf (mio, "%s\t%s:", sep,
-				      getFieldName (FIELD_FILE_SCOPE));
+		vStringCatS (line, sep);
+		vStringPut (line, '\t');
+		vStringCatS (line, getFieldName (FIELD_FILE_SCOPE));
+		vStringPut (line, ':');
 		sep [0] = '\0';
 	}
 
-	length += renderExtensionFieldMaybe (writer, FIELD_INHERITANCE, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_ACCESS, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_IMPLEMENTATION, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_SIGNATURE, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_ROLES, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_EXTRAS, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_XPATH, tag, sep, mio);
-	length += renderExtensionFieldMaybe (writer, FIELD_END_LINE, tag, sep, mio);
-
-	return length;
+	for (unsigned int i = 0; i < enabledFields.count; i++)
+		renderExtensionFieldMaybe (writer, enabledFields.others[i], tag, sep, line);
 }
 
 static int writeCtagsEntry (tagWriter *writer,
 							MIO * mio, const tagEntryInfo *const tag,
 							void *clientData CTAGS_ATTR_UNUSED)
 {
-	if (writer->private)
-	{
-		struct rejection *rej = writer->private;
-		if (hasTagEntryTabOrNewlineChar (tag))
-		{
-			rej->rejectionInThisInput = true;
-			return 0;
-		}
-	}
+	static vString *line;
+
+	/* A tag having a tab or newline character can't be written in the
+	 * e-ctags format; it is rejected. */
+	if (writer->type == WRITER_E_CTAGS && hasTagEntryTabOrNewlineChar (tag))
+		return 0;
+
+	/* The whole line is built in LINE, and then written at once. */
+	line = vStringNewOrClearWithAutoRelease (line);
 
-	int length = mio_printf (mio, "%s\t%s\t",
-			      escapeFieldValue (writer, tag, FIELD_NAME),
-			      escapeFieldValue (writer, tag, FIELD_INPUT_FILE));
+	renderFieldValue (writer, tag, FIELD_NAME, NO_PARSER_FIELD, line);
+	vStringPut (line, '\t');
+	renderFieldValue (writer, tag, FIELD_INPUT_FILE, NO_PARSER_FIELD, line);
+	vStringPut (line, '\t');
 
 	/* This is for handling 'common' of 'fortran'.  See the
 	   description of --excmd=mixed in ctags.1.  In tags output, what
@@ -341,23 +325,23 @@ static int writeCtagsEntry (tagWriter *writer,
 
 	   However, in the other formats, pattern should be pattern as its name. */
 	if (tag->lineNumberEntry)
-		length += writeLineNumberEntry (writer, mio, tag);
+		writeLineNumberEntry (writer, tag, line);
 	else
 	{
 		if (Option.locate == EX_COMBINE)
-			length += mio_printf(mio, "%lu;", tag->lineNumber + (Option.backward? 1: -1));
-		length += mio_puts(mio, escapeFieldValue(writer, tag, FIELD_PATTERN));
+			catNumber (line, "%lu;", tag->lineNumber + (Option.backward? 1: -1));
+		renderFieldValue (writer, tag, FIELD_PATTERN, NO_PARSER_FIELD, line);
 	}
 
 	if (includeExtensionFlags ())
 	{
-		length += addExtensionFields (writer, mio, tag);
-		length += addParserFields (writer, mio, tag);
+		addExtensionFields (writer, tag, line);
+		addParserFields (writer, tag, line);
 	}
 
-	length += mio_printf (mio, "\n");
+	vStringPut (line, '\n');
 
-	return length;
+	return (int) mio_write (mio, vStringValue (line), 1, vStringLength (line));
 }
 
 static int writeCtagsPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
@@ -401,6 +385,50 @@ static bool treatFieldAsFixed (int fieldType)
 	}
 }
 
+static void prepareEnabledFields (void)
+{
+	static vString *kindKey, *scopeKey;
+	const fieldType others [] = {
+		FIELD_INHERITANCE,
+		FIELD_ACCESS,
+		FIELD_IMPLEMENTATION,
+		FIELD_SIGNATURE,
+		FIELD_ROLES,
+		FIELD_EXTRAS,
+		FIELD_XPATH,
+		FIELD_END_LINE,
+	};
+
+	enabledFields.kind = isFieldEnabled (FIELD_KIND);
+	enabledFields.kindLong = isFieldEnabled (FIELD_KIND_LONG);
+	enabledFields.lineNumber = isFieldEnabled (FIELD_LINE_NUMBER);
+	enabledFields.language = isFieldEnabled (FIELD_LANGUAGE);
+	enabledFields.scope = isFieldEnabled (FIELD_SCOPE);
+	enabledFields.typeRef = isFieldEnabled (FIELD_TYPE_REF);
+	enabledFields.fileScope = isFieldEnabled (FIELD_FILE_SCOPE);
+
+	kindKey = vStringNewOrClearWithAutoRelease (kindKey);
+	if (isFieldEnabled (FIELD_KIND_KEY))
+	{
+		vStringCatS (kindKey, getFieldName (FIELD_KIND_KEY));
+		vStringPut (kindKey, ':');
+	}
+	enabledFields.kindKey = vStringValue (kindKey);
+
+	scopeKey = vStringNewOrClearWithAutoRelease (scopeKey);
+	if (isFieldEnabled (FIELD_SCOPE_KEY))
+	{
+		vStringCatS (scopeKey, getFieldName (FIELD_SCOPE_KEY));
+		vStringPut (scopeKey, ':');
+	}
+	enabledFields.scopeKey = vStringValue (scopeKey);
+
+	enabledFields.count = 0;
+	for (unsigned int i = 0; i < ARRAY_SIZE (others); i++)
+		if (isFieldEnabled (others [i]))
+			enabledFields.others [enabledFields.count++] = others [i];
+}
+
 static void checkCtagsOptions (tagWriter *writer CTAGS_ATTR_UNUSED)
 {
 	if (isFieldEnabled (FIELD_KIND_KEY)
@@ -31,7 +31,7 @@ static int writeEtagsEntry  (tagWriter *writer, MIO * mio, const tagEntryInfo *c
 							 void *clientData CTAGS_ATTR_UNUSED);
 static void *beginEtagsFile (tagWriter *writer, MIO * mio,
 							 void *clientData CTAGS_ATTR_UNUSED);
-static bool  endEtagsFile   (tagWriter *writer, MIO * mio, const char* filename,
+static void  endEtagsFile   (tagWriter *writer, MIO * mio, const char* filename,
 							 void *clientData CTAGS_ATTR_UNUSED);
 
 tagWriter etagsWriter = {
@@ -64,7 +64,7 @@ static void *beginEtagsFile (tagWriter *writer CTAGS_ATTR_UNUSED, MIO *mio CTAGS
 	return &etags;
 }
 
-static bool endEtagsFile (tagWriter *writer,
+static void endEtagsFile (tagWriter *writer,
 						  MIO *mainfp, const char *filename,
 						  void *clientData CTAGS_ATTR_UNUSED)
 {
@@ -90,7 +90,6 @@ static bool endEtagsFile (tagWriter *writer,
 		etags->mio = NULL;
 		etags->name = NULL;
 	}
-	return false;
 }
 
 static const char* ada_suffix (const tagEntryInfo *const tag, const char *const line)
@@ -5,6 +5,12 @@
 *   GNU General Public License version 2 or (at your option) any later version.
 *
 *   External interface to entry.c
+*
+*   A tag is written as a JSON object in a line. The members are put into
+*   the object in the order they are added; if a key is added twice, the
+*   last value replaces the first one at its place. A string which is not
+*   valid UTF-8 is not written. This is what jansson, the library used
+*   for this writer before, did with JSON_PRESERVE_ORDER.
 */
 
 #include "general.h"  /* must always come first */
@@ -17,18 +23,34 @@
 #include "read.h"
 #include "routines.h"
 #include "ptag_p.h"
+#include "trashbox.h"
+#include "vstring.h"
 #include "writer_p.h"
 
 
+#include <stdio.h>
 #include <string.h>
 
-#ifdef HAVE_JANSSON
-#include <jansson.h>
-
-#ifndef json_boolean /* compat with jansson < 2.4 */
-#define json_boolean(val)      ((val) ? json_true() : json_false())
-#endif
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sJsonMember {
+	const char *key;
+	size_t valueOffset;			/* in jsonObject.values */
+	size_t valueLength;
+} jsonMember;
+
+/* The object being built */
+static struct jsonObject {
+	jsonMember *members;
+	unsigned int count;
+	unsigned int allocated;
+	vString *values;			/* the values serialized */
+} jsonObject;
 
+/*
+*   FUNCTION DEFINITIONS
+*/
 
 static int writeJsonEntry  (tagWriter *writer CTAGS_ATTR_UNUSED,
 				MIO * mio, const tagEntryInfo *const tag,
@@ -52,6 +74,198 @@ tagWriter jsonWriter = {
 	.defaultFileName = NULL,
 };
 
+static bool isValidUtf8 (const char *s)
+{
+	const unsigned char *p = (const unsigned char *) s;
+
+	while (*p)
+	{
+		unsigned int c = *p++;
+		unsigned int value;
+		int count;
+
+		if (c < 0x80)
+			continue;
+		else if (c >= 0xc2 && c <= 0xdf)
+		{
+			count = 1;
+			value = c & 0x1f;
+		}
+		else if (c >= 0xe0 && c <= 0xef)
+		{
+			count = 2;
+			value = c & 0x0f;
+		}
+		else if (c >= 0xf0 && c <= 0xf4)
+		{
+			count = 3;
+			value = c & 0x07;
+		}
+		else
+			return false;
+
+		for (int i = 0; i < count; i++, p++)
+		{
+			if ((*p & 0xc0) != 0x80)
+				return false;
+			value = (value << 6) | (*p & 0x3f);
+		}
+
+		/* overlong forms, surrogates, and out of the range of Unicode */
+		if ((count == 2 && (value < 0x800 || (value >= 0xd800 && value <= 0xdfff)))
+			|| (count == 3 && (value < 0x10000 || value > 0x10ffff)))
+			return false;
+	}
+	return true;
+}
+
+static void catJsonString (vString *buffer, const char *s)
+{
+	vStringPut (buffer, '"');
+	while (*s)
+	{
+		const char *p = s;
+		while ((unsigned char) *p >= 0x20 && *p != '"' && *p != '\\')
+			p++;
+		if (p != s)
+		{
+			vStringNCatSUnsafe (buffer, s, p - s);
+			s = p;
+			if (*s == '\0')
+				break;
+		}
+
+		vStringPut (buffer, '\\');
+		switch (*s)
+		{
+		case '"':  vStringPut (buffer, '"');  break;
+		case '\\': vStringPut (buffer, '\\'); break;
+		case '\b': vStringPut (buffer, 'b');  break;
+		case '\f': vStringPut (buffer, 'f');  break;
+		case '\n': vStringPut (buffer, 'n');  break;
+		case '\r': vStringPut (buffer, 'r');  break;
+		case '\t': vStringPut (buffer, 't');  break;
+		default:
+		{
+			char u [7];
+			snprintf (u, sizeof (u), "u%04X", (unsigned int) (unsigned char) *s);
+			vStringCatS (buffer, u);
+			break;
+		}
+		}
+		s++;
+	}
+	vStringPut (buffer, '"');
+}
+
+static void beginObject (const char *type)
+{
+	jsonObject.count = 0;
+	jsonObject.values = vStringNewOrClearWithAutoRelease (jsonObject.values);
+	if (jsonObject.members == NULL)
+	{
+		jsonObject.allocated = 16;
+		jsonObject.members = xMalloc (jsonObject.allocated, jsonMember);
+		DEFAULT_TRASH_BOX (jsonObject.members, eFree);
+	}
+
+	vStringCatS (jsonObject.values, "\"");
+	vStringCatS (jsonObject.values, type);
+	vStringCatS (jsonObject.values, "\"");
+	jsonObject.members [0].key = "_type";
+	jsonObject.members [0].valueOffset = 0;
+	jsonObject.members [0].valueLength = vStringLength (jsonObject.values);
+	jsonObject.count = 1;
+}
+
+/* Make the value serialized at OFFSET in jsonObject.values the value
+ * for KEY. */
+static void setMember (const char *key, size_t offset)
+{
+	jsonMember *m = NULL;
+
+	for (unsigned int i = 0; i < jsonObject.count; i++)
+	{
+		if (strcmp (jsonObject.members [i].key, key) == 0)
+		{
+			m = jsonObject.members + i;
+			break;
+		}
+	}
+
+	if (m == NULL)
+	{
+		if (jsonObject.count == jsonObject.allocated)
+		{
+			DEFAULT_TRASH_BOX_TAKE_BACK (jsonObject.members);
+			jsonObject.allocated *= 2;
+			jsonObject.members = xRealloc (jsonObject.members, jsonObject.allocated, jsonMember);
+			DEFAULT_TRASH_BOX (jsonObject.members, eFree);
+		}
+		m = jsonObject.members + jsonObject.count++;
+		m->key = key;
+	}
+
+	m->valueOffset = offset;
+	m->valueLength = vStringLength (jsonObject.values) - offset;
+}
+
+static bool setString (const char *key, const char *value)
+{
+	size_t offset = vStringLength (jsonObject.values);
+
+	if (value == NULL || !isValidUtf8 (value))
+		return false;
+
+	catJsonString (jsonObject.values, value);
+	setMember (key, offset);
+	return true;
+}
+
+static void setLiteral (const char *key, const char *literal)
+{
+	size_t offset = vStringLength (jsonObject.values);
+
+	vStringCatS (jsonObject.values, literal);
+	setMember (key, offset);
+}
+
+static void setBoolean (const char *key, bool value)
+{
+	setLiteral (key, value? "true": "false");
+}
+
+static void setInteger (const char *key, long long value)
+{
+	char buf [32];
+
+	snprintf (buf, sizeof (buf), "%lld", value);
+	setLiteral (key, buf);
+}
+
+/* Write the object as a line. */
+static int writeObject (MIO *mio)
+{
+	static vString *line;
+
+	line = vStringNewOrClearWithAutoRelease (line);
+	vStringPut (line, '{');
+	for (unsigned int i = 0; i < jsonObject.count; i++)
+	{
+		const jsonMember *m = jsonObject.members + i;
+
+		if (i > 0)
+			vStringCatS (line, ", ");
+		catJsonString (line, m->key);
+		vStringCatS (line, ": ");
+		vStringNCatSUnsafe (line, vStringValue (jsonObject.values) + m->valueOffset,
+							m->valueLength);
+	}
+	vStringCatS (line, "}\n");
+
+	return (int) mio_write (mio, vStringValue (line), 1, vStringLength (line));
+}
+
 static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftype, int fieldIndex)
 {
 	const char *v;
@@ -63,7 +277,8 @@ static const char* escapeFieldValueRaw (const tagEntryInfo * tag, fieldType ftyp
 	return v;
 }
 
-static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool returnEmptyStringAsNoValue)
+static void setFieldValue (const char *key, const tagEntryInfo * tag, fieldType ftype,
+						   bool returnEmptyStringAsNoValue)
 {
 	const char *str = escapeFieldValueRaw (tag, ftype, NO_PARSER_FIELD);
 
@@ -73,35 +288,31 @@ static json_t* escapeFieldValue (const tagEntryInfo * tag, fieldType ftype, bool
 		if (dt & FIELDTYPE_STRING)
 		{
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				return json_false();
+				setBoolean (key, false);
 			else
-				return json_string (str);
+				setString (key, str);
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			long tmp;
 
 			if (strToLong (str, 10, &tmp))
-				return json_integer (tmp);
-			else
-				return NULL;
+				setInteger (key, tmp);
 		}
 		else if (dt & FIELDTYPE_BOOL)
 		{
 			/* TODO: This must be fixed when new boolean field is added.
 			   Currently only `file:' field use this. */
-			return json_boolean (strcmp ("-", str)); /* "-" -> false */
+			setBoolean (key, strcmp ("-", str)); /* "-" -> false */
 		}
-		AssertNotReached ();
-		return NULL;
+		else
+			AssertNotReached ();
 	}
 	else if (returnEmptyStringAsNoValue)
-		return json_false();
-	else
-		return NULL;
+		setBoolean (key, false);
 }
 
-static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag, json_t *response)
+static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag)
 {
 	const char *fname = getFieldName (xftype);
 
@@ -110,21 +321,18 @@ static void renderExtensionFieldMaybe (int xftype, const tagEntryInfo *const tag
 		switch (xftype)
 		{
 		case FIELD_LINE_NUMBER:
-			json_object_set_new (response, fname,
-					     json_integer (tag->lineNumber));
+			setInteger (fname, (long long) tag->lineNumber);
 			break;
 		case FIELD_FILE_SCOPE:
-			json_object_set_new (response, fname,
-					     json_boolean(1));
+			setBoolean (fname, true);
 			break;
 		default:
-			json_object_set_new (response, fname,
-					     escapeFieldValue (tag, xftype, false));
+			setFieldValue (fname, tag, xftype, false);
 		}
 	}
 }
 
-static void addParserFields (json_t *response, const tagEntryInfo *const tag)
+static void addParserFields (const tagEntryInfo *const tag)
 {
 	unsigned int i;
 
@@ -136,34 +344,32 @@ static void addParserFields (json_t *response, const tagEntryInfo *const tag)
 			continue;
 
 		unsigned int dt = getFieldDataType (ftype);
-		json_t *o;
+		const char *fname = getFieldName (ftype);
 		if (dt & FIELDTYPE_STRING)
 		{
 			const char *str = escapeFieldValueRaw (tag, ftype, i);
 			if (dt & FIELDTYPE_BOOL && str[0] == '\0')
-				o = json_false ();
+				setBoolean (fname, false);
 			else
-				o = json_string (str);
+				setString (fname, str);
 		}
 		else if (dt & FIELDTYPE_INTEGER)
 		{
 			/* NOT IMPLEMENTED YET */
 			AssertNotReached ();
-			o = json_null ();
+			setLiteral (fname, "null");
 		}
 		else if (dt & FIELDTYPE_BOOL)
-			o = json_true ();
+			setBoolean (fname, true);
 		else
 		{
 			AssertNotReached ();
-			o = json_null ();
+			setLiteral (fname, "null");
 		}
-
-		json_object_set_new (response, getFieldName (ftype), o);
 	}
 }
 
-static void addExtensionFields (json_t *response, const tagEntryInfo *const tag)
+static void addExtensionFields (const tagEntryInfo *const tag)
 {
 	int k;
 
@@ -184,49 +390,36 @@ static void addExtensionFields (json_t *response, const tagEntryInfo *const tag)
 	}
 
 	for (k = FIELD_EXTENSION_START; k <= FIELD_BUILTIN_LAST; k++)
-		renderExtensionFieldMaybe (k, tag, response);
+		renderExtensionFieldMaybe (k, tag);
 }
 
 static int writeJsonEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 			       MIO * mio, const tagEntryInfo *const tag,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
-	int length = 0;
-	json_t *response = json_pack ("{ss}", "_type", "tag");
+	beginObject ("tag");
 
 	if (isFieldEnabled (FIELD_NAME))
 	{
-		json_t *name = json_string (tag->name);
-		if (name == NULL)
-			goto out;
-		json_object_set_new (response, "name", name);
+		if (!setString ("name", tag->name))
+			return 0;
 	}
 	if (isFieldEnabled (FIELD_INPUT_FILE))
-		json_object_set_new (response, "path", json_string (tag->sourceFileName));
+		setString ("path", tag->sourceFileName);
 	if (isFieldEnabled (FIELD_PATTERN))
-	{
-		json_t *pat = escapeFieldValue(tag, FIELD_PATTERN, true);
-		json_object_set_new (response, "pattern", pat);
-	}
+		setFieldValue ("pattern", tag, FIELD_PATTERN, true);
 
 	if (includeExtensionFlags ())
 	{
-		addExtensionFields (response, tag);
-		addParserFields (response, tag);
+		addExtensionFields (tag);
+		addParserFields (tag);
 	}
 
-	/* Print nothing if RESPONSE has only "_type" field. */
-	if (json_object_size (response) == 1)
-		goto out;
+	/* Print nothing if the object has only "_type" field. */
+	if (jsonObject.count == 1)
+		return 0;
 
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	length = mio_printf (mio, "%s\n", buf);
-
-	free (buf);
- out:
-	json_decref (response);
-
-	return length;
+	return writeObject (mio);
 }
 
 static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
@@ -237,32 +430,15 @@ static int writeJsonPtagEntry (tagWriter *writer CTAGS_ATTR_UNUSED,
 				   void *clientData CTAGS_ATTR_UNUSED)
 {
 #define OPT(X) ((X)?(X):"")
-	json_t *response;
+	beginObject ("ptag");
 
-	if (parserName)
-	{
-		response = json_pack ("{ss ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "parserName", parserName,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
-	}
-	else
-	{
-		response = json_pack ("{ss ss ss ss}",
-				      "_type", "ptag",
-				      "name", desc->name,
-				      "path", OPT(fileName),
-				      "pattern", OPT(pattern));
-	}
+	if (!setString ("name", desc->name)
+		|| (parserName && !setString ("parserName", parserName))
+		|| !setString ("path", OPT(fileName))
+		|| !setString ("pattern", OPT(pattern)))
+		return 0;
 
-	char *buf = json_dumps (response, JSON_PRESERVE_ORDER);
-	int length = mio_printf (mio, "%s\n", buf);
-	free (buf);
-	json_decref (response);
-
-	return length;
+	return writeObject (mio);
 #undef OPT
 }
 
@@ -274,21 +450,3 @@ extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_A
 			       "in development",
 			       NULL);
 }
-
-#else /* HAVE_JANSSON */
-
-tagWriter jsonWriter = {
-	.writeEntry = NULL,
-	.writePtagEntry = NULL,
-	.preWriteEntry = NULL,
-	.postWriteEntry = NULL,
-	.defaultFileName = "-",
-};
-
-extern bool ptagMakeJsonOutputVersion (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED,
-									   const void *data CTAGS_ATTR_UNUSED)
-{
-	return false;
-}
-
-#endif
@@ -49,17 +49,14 @@ extern void writerSetup (MIO *mio, void *clientData)
 		writer->private = NULL;
 }
 
-extern bool writerTeardown (MIO *mio, const char *filename)
+extern void writerTeardown (MIO *mio, const char *filename)
 {
 	if (writer->postWriteEntry)
 	{
-		bool r;
-		r = writer->postWriteEntry (writer, mio, filename,
-									writer->clientData);
+		writer->postWriteEntry (writer, mio, filename,
+								writer->clientData);
 		writer->private = NULL;
-		return r;
 	}
-	return false;
 }
 
 extern int writerWriteTag (MIO * mio, const tagEntryInfo *const tag)
@@ -115,6 +112,21 @@ extern bool writerCanPrintPtag (void)
 	return (writer->writePtagEntry)? true: false;
 }
 
+/* Whether a tag file can be updated with --incremental.
+ * It is possible only if each tag is on a line, and the name of the
+ * input file is in the second column of the line. */
+extern bool writerCanUpdateTagFile (void)
+{
+	return (writer->type == WRITER_U_CTAGS || writer->type == WRITER_E_CTAGS);
+}
+
+/* Whether the names of the input files are escaped in such a tag file.
+ * The e-ctags writer writes them as they are. */
+extern bool writerDoesEscapeInputFileName (void)
+{
+	return (writer->type != WRITER_E_CTAGS);
+}
+
 extern bool writerDoesTreatFieldAsFixed (int fieldType)
 {
 	if (writer->treatFieldAsFixed)
@@ -44,9 +44,7 @@ struct sTagWriter {
 	void * (* preWriteEntry) (tagWriter *writer, MIO * mio,
 							  void *clientData);
 
-	/* Returning TRUE means the output file may be shrunk.
-	   In such case the callee may do truncate output file. */
-	bool (* postWriteEntry)  (tagWriter *writer, MIO * mio, const char* filename,
+	void (* postWriteEntry)  (tagWriter *writer, MIO * mio, const char* filename,
 							  void *clientData);
 	void (* rescanFailedEntry) (tagWriter *writer, unsigned long validTagNum,
 								void *clientData);
@@ -72,7 +70,7 @@ struct sTagWriter {
 /* customWriter is used only if otype is WRITER_CUSTOM */
 extern void setTagWriter (writerType otype, tagWriter *customWriter);
 extern void writerSetup  (MIO *mio, void *clientData);
-extern bool writerTeardown (MIO *mio, const char *filename);
+extern void writerTeardown (MIO *mio, const char *filename);
 
 int writerWriteTag (MIO * mio, const tagEntryInfo *const tag);
 int writerWritePtag (MIO * mio,
@@ -94,6 +92,8 @@ extern bool ptagMakeCtagsOutputMode (ptagDesc *desc, langType language CTAGS_ATT
 extern bool ptagMakeCtagsOutputFilesep (ptagDesc *desc, langType language CTAGS_ATTR_UNUSED, const void *data);
 
 extern bool writerCanPrintPtag (void);
+extern bool writerCanUpdateTagFile (void);
+extern bool writerDoesEscapeInputFileName (void);
 extern bool writerDoesTreatFieldAsFixed (int fieldType);
 
 extern void writerCheckOptions (void);
@@ -0,0 +1,226 @@
+/*
+*   Copyright (c) 2026, Universal Ctags Team
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License version 2 or (at your option) any later version.
+*
+*   A micro-benchmark comparing the hash table in main/htable.c with the
+*   chained hash table it replaced.
+*
+*   Build and run it in the build directory:
+*
+*     make bench-htable
+*     ./bench-htable [N]
+*
+*   Each workload is run with N keys (100000 by default). "small" tables
+*   are made with the initial size 17 which the chained hash table could
+*   not change.
+*/
+
+#include "general.h"
+#include "htable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+*   The previous implementation: an array of singly linked lists
+*/
+typedef struct sChainEntry {
+	void *key;
+	void *value;
+	struct sChainEntry *next;
+} chainEntry;
+
+typedef struct sChainTable {
+	chainEntry **table;
+	unsigned int size;
+	hashTableHashFunc hashfn;
+	hashTableEqualFunc equalfn;
+} chainTable;
+
+static chainTable *chainTableNew (unsigned int size,
+								  hashTableHashFunc hashfn, hashTableEqualFunc equalfn)
+{
+	chainTable *t = malloc (sizeof (chainTable));
+
+	t->table = calloc (size, sizeof (chainEntry *));
+	t->size = size;
+	t->hashfn = hashfn;
+	t->equalfn = equalfn;
+	return t;
+}
+
+static void chainTableClear (chainTable *t)
+{
+	for (unsigned int i = 0; i < t->size; i++)
+	{
+		chainEntry *e = t->table[i];
+		while (e)
+		{
+			chainEntry *next = e->next;
+			free (e);
+			e = next;
+		}
+		t->table[i] = NULL;
+	}
+}
+
+static void chainTableDelete (chainTable *t)
+{
+	chainTableClear (t);
+	free (t->table);
+	free (t);
+}
+
+static void chainTablePutItem (chainTable *t, void *key, void *value)
+{
+	unsigned int i = t->hashfn (key) % t->size;
+	chainEntry *e = malloc (sizeof (chainEntry));
+
+	e->key = key;
+	e->value = value;
+	e->next = t->table[i];
+	t->table[i] = e;
+}
+
+static void *chainTableGetItem (chainTable *t, const void *key)
+{
+	unsigned int i = t->hashfn (key) % t->size;
+
+	for (chainEntry *e = t->table[i]; e; e = e->next)
+		if (t->equalfn (key, e->key))
+			return e->value;
+	return NULL;
+}
+
+/*
+*   Workloads
+*/
+struct workload {
+	const char *name;
+	unsigned int initialSize;
+	hashTableHashFunc hashfn;
+	hashTableEqualFunc equalfn;
+	bool stringKeys;
+	int rounds;				/* put all, look up all, and clear */
+};
+
+static double elapsed (clock_t start)
+{
+	return (double) (clock () - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static unsigned long runOpenAddressing (const struct workload *w, void **keys, void **misses, int n)
+{
+	hashTable *t = hashTableNew (w->initialSize, w->hashfn, w->equalfn, NULL, NULL);
+	unsigned long found = 0;
+
+	for (int r = 0; r < w->rounds; r++)
+	{
+		for (int i = 0; i < n; i++)
+			hashTablePutItem (t, keys[i], keys[i]);
+		for (int i = 0; i < n; i++)
+		{
+			found += hashTableGetItem (t, keys[i]) != NULL;
+			found += hashTableGetItem (t, misses[i]) != NULL;
+		}
+		hashTableClear (t);
+	}
+	hashTableDelete (t);
+	return found;
+}
+
+static unsigned long runChained (const struct workload *w, void **keys, void **misses, int n)
+{
+	chainTable *t = chainTableNew (w->initialSize, w->hashfn, w->equalfn);
+	unsigned long found = 0;
+
+	for (int r = 0; r < w->rounds; r++)
+	{
+		for (int i = 0; i < n; i++)
+			chainTablePutItem (t, keys[i], keys[i]);
+		for (int i = 0; i < n; i++)
+		{
+			found += chainTableGetItem (t, keys[i]) != NULL;
+			found += chainTableGetItem (t, misses[i]) != NULL;
+		}
+		chainTableClear (t);
+	}
+	chainTableDelete (t);
+	return found;
+}
+
+static void **makeKeys (int n, bool stringKeys, const char *prefix)
+{
+	void **keys = malloc (n * sizeof (void *));
+
+	for (int i = 0; i < n; i++)
+	{
+		if (stringKeys)
+		{
+			char buf[32];
+			snprintf (buf, sizeof (buf), "%s%d", prefix, i);
+			keys[i] = strdup (buf);
+		}
+		else
+			keys[i] = malloc (16);
+	}
+	return keys;
+}
+
+static void freeKeys (void **keys, int n)
+{
+	for (int i = 0; i < n; i++)
+		free (keys[i]);
+	free (keys);
+}
+
+int main (int argc, char **argv)
+{
+	const int n = (argc > 1)? atoi (argv[1]): 100000;
+	const struct workload workloads[] = {
+		{ "string keys, size 1021", 1021, hashCstrhash, hashCstreq, true, 10 },
+		{ "string keys, size 17", 17, hashCstrhash, hashCstreq, true, 1 },
+		{ "pointer keys, size 1021", 1021, hashPtrhash, hashPtreq, false, 10 },
+		{ "pointer keys, size 17", 17, hashPtrhash, hashPtreq, false, 1 },
+	};
+
+	if (n <= 0)
+	{
+		fprintf (stderr, "usage: %s [N]\n", argv[0]);
+		return 1;
+	}
+
+	printf ("%-28s %14s %14s\n", "workload", "chained (ms)", "open (ms)");
+	for (unsigned int i = 0; i < sizeof (workloads) / sizeof (workloads[0]); i++)
+	{
+		const struct workload *w = workloads + i;
+		void **keys = makeKeys (n, w->stringKeys, "key");
+		void **misses = makeKeys (n, w->stringKeys, "miss");
+		unsigned long found0, found1;
+		double t0, t1;
+		clock_t start;
+
+		start = clock ();
+		found0 = runChained (w, keys, misses, n);
+		t0 = elapsed (start);
+
+		start = clock ();
+		found1 = runOpenAddressing (w, keys, misses, n);
+		t1 = elapsed (start);
+
+		if (found0 != found1)
+		{
+			fprintf (stderr, "%s: results differ: %lu != %lu\n", w->name, found0, found1);
+			return 1;
+		}
+		printf ("%-28s %14.1f %14.1f\n", w->name, t0, t1);
+
+		freeKeys (misses, n);
+		freeKeys (keys, n);
+	}
+	return 0;
+}
@@ -14,6 +14,7 @@
 #include "general.h"  /* must always come first */
 
 #include <string.h>
+#include <limits.h>
 
 #include "debug.h"
 #include "entry.h"
@@ -35,6 +36,9 @@
 #define stringMatch(s1,s2)		(strcmp (s1,s2) == 0)
 #define isspacetab(c)			((c) == SPACE || (c) == TAB)
 
+/* Only the beginning of a long string literal is kept. */
+#define STRING_CONTENTS_LIMIT	1024
+
 /*
 *   DATA DECLARATIONS
 */
@@ -521,6 +525,25 @@ static int cppGetcFromUngetBufferOrFile(void)
 	return getcFromInputFile();
 }
 
+/*  Skips to one of the characters in "chars", and returns it, or EOF.
+ *  Unless "skipped" is NULL, the skipped characters are appended to it.
+ *  Once the unget buffer is empty, the input file is searched in bulk.
+ */
+static int cppSkipToCharacters (const char *const chars, vString *const skipped)
+{
+	while (Cpp.ungetPointer)
+	{
+		int c = cppGetcFromUngetBufferOrFile ();
+
+		if (c == EOF || (c > 0 && c <= UCHAR_MAX && strchr (chars, c)))
+			return c;
+		if (skipped)
+			vStringPut (skipped, c);
+	}
+
+	return skipToCharactersInInputFile (chars, skipped);
+}
+
 
 /*  Reads a directive, whose first character is given by "c", into "name".
  */
@@ -1071,7 +1094,7 @@ static int cppSkipOverCComment (void)
 	while (c != EOF)
 	{
 		if (c != '*')
-			c = cppGetcFromUngetBufferOrFile ();
+			c = cppSkipToCharacters ("*", NULL);
 		else
 		{
 			const int next = cppGetcFromUngetBufferOrFile ();
@@ -1094,7 +1117,7 @@ static int skipOverCplusComment (void)
 {
 	int c;
 
-	while ((c = cppGetcFromUngetBufferOrFile ()) != EOF)
+	while ((c = cppSkipToCharacters ("\\\n", NULL)) != EOF)
 	{
 		if (c == BACKSLASH)
 			cppGetcFromUngetBufferOrFile ();  /* throw away next character, too */
@@ -1114,7 +1137,7 @@ static int skipOverDComment (void)
 	while (c != EOF)
 	{
 		if (c != '+')
-			c = cppGetcFromUngetBufferOrFile ();
+			c = cppSkipToCharacters ("+", NULL);
 		else
 		{
 			const int next = cppGetcFromUngetBufferOrFile ();
@@ -1142,23 +1165,36 @@ const vString * cppGetLastCharOrStringContents (void)
  */
 static int skipToEndOfString (bool ignoreBackslash)
 {
+	vString *const contents = Cpp.charOrStringContents;
+	bool collecting = true;
 	int c;
 
-	vStringClear(Cpp.charOrStringContents);
+	vStringClear(contents);
 
-	while ((c = cppGetcFromUngetBufferOrFile ()) != EOF)
+	/* Collect the contents a line at a time, up to STRING_CONTENTS_LIMIT.
+	 * Past that point the rest of the string, or the rest of the input for
+	 * an unterminated one, is only skipped. */
+	while ((c = cppSkipToCharacters (collecting? "\\\"\n": "\\\"",
+	                                 collecting? contents: NULL)) != EOF)
 	{
 		if (c == BACKSLASH && ! ignoreBackslash)
 		{
-			vStringPutWithLimit (Cpp.charOrStringContents, c, 1024);
+			if (collecting)
+				vStringPut (contents, c);
 			c = cppGetcFromUngetBufferOrFile ();  /* throw away next character, too */
-			if (c != EOF)
-				vStringPutWithLimit (Cpp.charOrStringContents, c, 1024);
+			if (c != EOF && collecting)
+				vStringPut (contents, c);
 		}
 		else if (c == DOUBLE_QUOTE)
 			break;
-		else
-			vStringPutWithLimit (Cpp.charOrStringContents, c, 1024);
+		else if (collecting)
+			vStringPut (contents, c);
+
+		if (collecting && vStringLength (contents) >= STRING_CONTENTS_LIMIT)
+		{
+			vStringTruncate (contents, STRING_CONTENTS_LIMIT);
+			collecting = false;
+		}
 	}
 	return STRING_SYMBOL;  /* symbolic representation of string */
 }
@@ -2625,6 +2625,8 @@ static rescanReason findFortranTags (const unsigned int passCount)
 	token = newToken ();
 
 	FreeSourceForm = (bool) (passCount > 1);
+	if (passCount == 1)
+		FreeSourceFormFound = false;
 	Column = 0;
 	parseProgramUnit (token);
 	if (FreeSourceFormFound  &&  ! FreeSourceForm)
@@ -49,7 +49,9 @@ MAIN_PUBLIC_HEADS =		\
 	$(NULL)
 
 LIB_PRIVATE_HEADS =		\
+	main/arena_p.h		\
 	main/args_p.h		\
+	main/cache_p.h		\
 	main/colprint_p.h	\
 	main/dependency_p.h	\
 	main/entry_p.h		\
@@ -57,7 +59,10 @@ LIB_PRIVATE_HEADS =		\
 	main/field_p.h		\
 	main/flags_p.h		\
 	main/fmt_p.h		\
+	main/globset_p.h	\
+	main/incremental_p.h	\
 	main/interactive_p.h	\
+	main/jobs_p.h		\
 	main/keyword_p.h	\
 	main/kind_p.h		\
 	main/lregex_p.h		\
@@ -73,9 +78,11 @@ LIB_PRIVATE_HEADS =		\
 	main/ptag_p.h		\
 	main/read_p.h		\
 	main/routines_p.h	\
+	main/server_p.h		\
 	main/sort_p.h		\
 	main/stats_p.h		\
 	main/subparser_p.h	\
+	main/tagindex_p.h	\
 	main/trashbox_p.h	\
 	main/writer_p.h		\
 	main/xtag_p.h		\
@@ -92,7 +99,9 @@ LIB_HEADS =			\
 	$(MIO_HEADS)
 
 LIB_SRCS =			\
+	main/arena.c			\
 	main/args.c			\
+	main/cache.c			\
 	main/colprint.c			\
 	main/dependency.c		\
 	main/entry.c			\
@@ -101,7 +110,10 @@ LIB_SRCS =			\
 	main/field.c			\
 	main/flags.c			\
 	main/fmt.c			\
+	main/globset.c		\
 	main/htable.c			\
+	main/incremental.c		\
+	main/jobs.c			\
 	main/keyword.c			\
 	main/kind.c			\
 	main/lregex.c			\
@@ -123,9 +135,11 @@ LIB_SRCS =			\
 	main/routines.c			\
 	main/seccomp.c			\
 	main/selectors.c		\
+	main/server.c			\
 	main/sort.c			\
 	main/stats.c			\
 	main/strlist.c			\
+	main/tagindex.c		\
 	main/trace.c			\
 	main/trashbox.c			\
 	main/tokeninfo.c		\